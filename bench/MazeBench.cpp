@@ -0,0 +1,402 @@
+/*****************************************************************************************
+ **                     3D MAZE - BENCHMARK                                             **
+ **         Times building, reading, solving and printing mazes over a sweep of         **
+ **         sizes and biases, compares the generators, and reports the results as JSON. **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "Maze.h"
+#include "FixedMaze.h"
+#include "MazeAnalysis.h"
+#include "MazeBatch.h"
+#include "MazeGenerator.h"
+#include "MazePipeline.h"
+#include "MazeSolver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#define BENCH_HAVE_RUSAGE 1
+#endif
+
+/* Every allocation in the program goes through these, so each phase can report
+ * how many allocations it made, how many bytes it asked for, and the most heap memory in use at once.
+ * Each block starts with its size, so deletes know how much is freed.
+ */
+namespace {
+    const std::size_t HEADER = 16;   // Keeps the blocks aligned as malloc's
+
+    std::atomic<uint64_t> allocations(0);
+    std::atomic<uint64_t> allocated_bytes(0);
+    std::atomic<uint64_t> live_bytes(0);
+    std::atomic<uint64_t> peak_bytes(0);
+
+    void *counted_new(std::size_t size){
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+        char *memory = static_cast<char*>(std::malloc(size + HEADER));
+        if (!memory){
+            throw std::bad_alloc();
+        }
+        *reinterpret_cast<std::size_t*>(memory) = size;
+
+        uint64_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        uint64_t peak = peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)){
+        }
+        return memory + HEADER;
+    }
+
+    void counted_delete(void *memory){
+        if (memory){
+            char *block = static_cast<char*>(memory) - HEADER;
+            live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+            std::free(block);
+        }
+    }
+}
+
+void *operator new(std::size_t size){ return counted_new(size); }
+void *operator new[](std::size_t size){ return counted_new(size); }
+void operator delete(void *memory) noexcept { counted_delete(memory); }
+void operator delete[](void *memory) noexcept { counted_delete(memory); }
+void operator delete(void *memory, std::size_t) noexcept { counted_delete(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { counted_delete(memory); }
+
+namespace {
+    struct Size   { int length, width, height; };
+    struct Biases { double horizontal, vertical; };
+
+    // Tiny to tens of millions of rooms
+    const Size SIZES[] = {
+        {10, 5, 4},
+        {64, 64, 8},
+        {256, 256, 16},
+        {1000, 1000, 8},
+        {2000, 2000, 8},
+    };
+    // Many small mazes per call (see MazeBatch)
+    constexpr Size BATCH_SIZE = {16, 16, 4};
+
+    const Biases BIASES[] = {
+        {0.5, 0.5},
+        {0.25, 0.75},
+        {0.75, 0.25},
+    };
+
+    struct Phase {
+        std::string name;
+        double seconds;
+        uint64_t allocations;
+        uint64_t allocated_bytes;
+        uint64_t peak_heap_bytes;   // Most heap memory in use at once, above what was in use before
+    };
+
+    long peak_rss_kb(){
+        // Largest resident set so far, for the whole process (0 if unknown)
+#ifdef BENCH_HAVE_RUSAGE
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0){
+#ifdef __APPLE__
+            return usage.ru_maxrss / 1024;
+#else
+            return usage.ru_maxrss;
+#endif
+        }
+#endif
+        return 0;
+    }
+
+    template<class Work>
+    Phase measure(const std::string &name, int repeat, Work work){
+        // Best time of repeat runs. Allocations are those of the last run.
+        Phase phase = {name, 0, 0, 0, 0};
+        for (int run = 0; run < repeat; run++){
+            uint64_t count = allocations.load();
+            uint64_t bytes = allocated_bytes.load();
+            uint64_t live = live_bytes.load();
+            peak_bytes = live;
+            auto start = std::chrono::steady_clock::now();
+
+            work();
+
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || seconds < phase.seconds){
+                phase.seconds = seconds;
+            }
+            phase.allocations = allocations.load() - count;
+            phase.allocated_bytes = allocated_bytes.load() - bytes;
+            phase.peak_heap_bytes = peak_bytes.load() - live;
+        }
+        return phase;
+    }
+
+    void usage(const char *program){
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --max-rooms N   Skip sizes with more than N rooms (default 50000000)\n"
+                  << "  --repeat N      Runs of each phase; the best time is kept (default 1)\n"
+                  << "  --threads N     Threads for build_parallel and print (default 0 = all)\n"
+                  << "  --seed N        Seed of every maze (default 1)\n"
+                  << "  --batch N       Mazes of 16x16x4 rooms per MazeBatch call (default 10000, 0 = none)\n"
+                  << "  --simd 0|1      Use the AVX2 row kernel if the processor has it (default 1)\n"
+                  << "  --output FILE   Write the JSON to FILE instead of standard output\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t max_rooms = 50000000;
+    int repeat = 1;
+    unsigned threads = 0;
+    uint64_t seed = 1;
+    std::size_t batch = 10000;
+    std::string output;
+
+    for (int i = 1; i < argc; i++){
+        std::string option = argv[i];
+        if (i + 1 >= argc){
+            usage(argv[0]);
+            return 1;
+        }
+        if (option == "--max-rooms"){
+            max_rooms = std::strtoull(argv[++i], nullptr, 10);
+        } else if (option == "--repeat"){
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (option == "--threads"){
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--batch"){
+            batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (option == "--simd"){
+            MazeRandom::use_simd(std::atoi(argv[++i]) != 0);
+        } else if (option == "--seed"){
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (option == "--output"){
+            output = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+#ifdef BENCH_HAVE_RUSAGE
+    int null_fd = open("/dev/null", O_WRONLY);
+#else
+    int null_fd = -1;
+#endif
+
+    std::ostringstream json;
+    json << "{\n  \"benchmark\": \"maze\",\n  \"repeat\": " << repeat
+         << ",\n  \"threads\": " << threads << ",\n  \"seed\": " << seed
+         << ",\n  \"simd\": " << (MazeRandom::simd() ? "true" : "false") << ",\n  \"results\": [";
+    bool first_result = true;
+
+    for (const Size &size : SIZES){
+        uint64_t rooms = (uint64_t)size.length * size.width * size.height;
+        if (rooms > max_rooms){
+            continue;
+        }
+
+        for (const Biases &biases : BIASES){
+            Maze maze(size.length, size.width, size.height, biases.horizontal, biases.vertical, seed);
+            std::vector<Phase> phases;
+
+            phases.push_back(measure("build", repeat, [&]{ maze.build(); }));
+            BuildStats build_stats = maze.stats();
+            phases.push_back(measure("build_parallel", repeat, [&]{ maze.build_parallel(threads); }));
+
+            // Reads the walls of every room, as the cell values of old were read
+            volatile long sum = 0;
+            phases.push_back(measure("query", repeat, [&]{
+                long total = 0;
+                for (int floor = 0; floor < maze.HEIGHT; floor++){
+                    for (int row = 0; row < maze.WIDTH; row++){
+                        for (int col = 0; col < maze.LENGTH; col++){
+                            total += maze(row, col, floor);
+                        }
+                    }
+                }
+                sum = total;
+            }));
+
+            // From corner to corner, through every floor
+            MazeSolver solver(maze);
+            std::size_t path_length = 0;
+            phases.push_back(measure("solve", repeat, [&]{
+                path_length = solver.bfs(0, 0, 0, maze.WIDTH - 1, maze.LENGTH - 1, maze.HEIGHT - 1).length;
+            }));
+
+            // Checks the maze is perfect, and measures it
+            phases.push_back(measure("analyze", repeat, [&]{ MazeAnalysis analysis(maze); }));
+
+            // Time until the first floor of a pipelined build is ready (the rest is stopped)
+            phases.push_back(measure("first_floor", repeat, [&]{
+                MazePipeline pipeline(size.length, size.width, size.height, biases.horizontal, biases.vertical, seed);
+                MazePipeline::Floor floor;
+                pipeline.next(floor);
+            }));
+
+            if (null_fd >= 0){
+                phases.push_back(measure("print", repeat, [&]{ maze.print(null_fd, threads); }));
+            }
+
+            json << (first_result ? "\n" : ",\n");
+            first_result = false;
+
+            json << "    {\"length\": " << size.length << ", \"width\": " << size.width << ", \"height\": " << size.height
+                 << ", \"rooms\": " << rooms
+                 << ", \"horizontal_bias\": " << biases.horizontal << ", \"vertical_bias\": " << biases.vertical
+                 << ", \"path_length\": " << path_length
+                 << ", \"peak_rss_kb\": " << peak_rss_kb() << ",\n     \"phases\": {";
+
+            for (std::size_t p = 0; p < phases.size(); p++){
+                const Phase &phase = phases[p];
+                json << (p ? ",\n       " : "\n       ")
+                     << "\"" << phase.name << "\": {\"seconds\": " << phase.seconds
+                     << ", \"rooms_per_second\": " << (phase.seconds > 0 ? rooms / phase.seconds : 0)
+                     << ", \"allocations\": " << phase.allocations
+                     << ", \"allocated_bytes\": " << phase.allocated_bytes
+                     << ", \"peak_heap_bytes\": " << phase.peak_heap_bytes << "}";
+            }
+            json << "}";
+
+            // Where the time of the last build went (with MAZE_INSTRUMENT)
+            if (BuildStats::ENABLED){
+                json << ",\n     \"build_stats\": ";
+                build_stats.write_json(json);
+            }
+            json << "}";
+
+            std::cerr << size.length << "x" << size.width << "x" << size.height
+                      << " biases " << biases.horizontal << "/" << biases.vertical << ": build "
+                      << phases[0].seconds << "s (" << rooms / phases[0].seconds << " rooms/s)\n";
+        }
+    }
+    json << "\n  ]";
+
+    // Each generator at each size, for speed and memory (see MazeGenerator.h)
+    EllerGenerator eller;
+    KruskalGenerator kruskal;
+    WilsonGenerator wilson;
+    GrowingTreeGenerator backtracker(1.0), random_tree(0.0);
+    const std::pair<const char*, const MazeGenerator*> generators[] = {
+        {"eller", &eller},
+        {"kruskal", &kruskal},
+        {"wilson", &wilson},
+        {"growing_tree_newest", &backtracker},
+        {"growing_tree_random", &random_tree},
+    };
+
+    json << ",\n  \"generators\": [";
+    first_result = true;
+    for (const Size &size : SIZES){
+        uint64_t rooms = (uint64_t)size.length * size.width * size.height;
+        if (rooms > max_rooms){
+            continue;
+        }
+        for (const auto &generator : generators){
+            Maze maze(size.length, size.width, size.height, 0.5, 0.5, seed);
+            Phase phase = measure(generator.first, repeat, [&]{ maze.build(*generator.second); });
+            MazeAnalysis analysis(maze);
+
+            json << (first_result ? "\n" : ",\n");
+            first_result = false;
+
+            json << "    {\"generator\": \"" << phase.name << "\", \"length\": " << size.length
+                 << ", \"width\": " << size.width << ", \"height\": " << size.height << ", \"rooms\": " << rooms
+                 << ", \"seconds\": " << phase.seconds
+                 << ", \"rooms_per_second\": " << (phase.seconds > 0 ? rooms / phase.seconds : 0)
+                 << ", \"allocations\": " << phase.allocations
+                 << ", \"allocated_bytes\": " << phase.allocated_bytes
+                 << ", \"peak_heap_bytes\": " << phase.peak_heap_bytes
+                 << ",\n     \"analysis\": ";
+            analysis.write_json(json);
+            json << "}";
+
+            std::cerr << size.length << "x" << size.width << "x" << size.height << " " << phase.name << ": "
+                      << phase.seconds << "s (" << rooms / phase.seconds << " rooms/s)\n";
+        }
+    }
+    json << "\n  ]";
+
+    if (batch > 0){
+        MazeBatch mazes(BATCH_SIZE.length, BATCH_SIZE.width, BATCH_SIZE.height, 0.5, 0.5);
+        std::vector<uint64_t> seeds(batch);
+        for (std::size_t i = 0; i < batch; i++){
+            seeds[i] = seed + i;
+        }
+
+        // The first call grows the arena and the streams; the rest should not allocate.
+        mazes.generate(seeds, threads);
+        Phase phase = measure("batch", repeat, [&]{ mazes.generate(seeds, threads); });
+
+        json << ",\n  \"batch\": {\"length\": " << BATCH_SIZE.length << ", \"width\": " << BATCH_SIZE.width
+             << ", \"height\": " << BATCH_SIZE.height << ", \"mazes\": " << batch
+             << ", \"seconds\": " << phase.seconds
+             << ", \"mazes_per_second\": " << (phase.seconds > 0 ? batch / phase.seconds : 0)
+             << ", \"allocations\": " << phase.allocations
+             << ", \"allocated_bytes\": " << phase.allocated_bytes
+             << ", \"peak_heap_bytes\": " << phase.peak_heap_bytes << "}";
+
+        std::cerr << "batch of " << batch << " mazes: " << batch / phase.seconds << " mazes/s\n";
+
+        // The same mazes one at a time, as FixedMaze (checked to be the mazes of the batch)
+        typedef FixedMaze<BATCH_SIZE.length, BATCH_SIZE.width, BATCH_SIZE.height> BatchMaze;
+        static BatchMaze fixed(0.5, 0.5);
+        bool same = true;
+        for (std::size_t i = 0; i < batch; i++){
+            fixed = BatchMaze(0.5, 0.5, seeds[i]);
+            fixed.build();
+            same &= std::equal(fixed.data().begin(), fixed.data().end(), mazes.data(i));
+        }
+        Phase fixed_phase = measure("fixed", repeat, [&]{
+            for (std::size_t i = 0; i < batch; i++){
+                fixed = BatchMaze(0.5, 0.5, seeds[i]);
+                fixed.build();
+            }
+        });
+
+        json << ",\n  \"fixed\": {\"length\": " << BATCH_SIZE.length << ", \"width\": " << BATCH_SIZE.width
+             << ", \"height\": " << BATCH_SIZE.height << ", \"mazes\": " << batch
+             << ", \"same_as_maze\": " << (same ? "true" : "false")
+             << ", \"seconds\": " << fixed_phase.seconds
+             << ", \"mazes_per_second\": " << (fixed_phase.seconds > 0 ? batch / fixed_phase.seconds : 0)
+             << ", \"allocations\": " << fixed_phase.allocations
+             << ", \"allocated_bytes\": " << fixed_phase.allocated_bytes
+             << ", \"peak_heap_bytes\": " << fixed_phase.peak_heap_bytes << "}";
+
+        std::cerr << "fixed: " << batch / fixed_phase.seconds << " mazes/s" << (same ? "" : " (NOT the mazes of the batch)") << "\n";
+    }
+    json << "\n}\n";
+
+#ifdef BENCH_HAVE_RUSAGE
+    if (null_fd >= 0){
+        close(null_fd);
+    }
+#endif
+
+    if (output.empty()){
+        std::cout << json.str();
+    } else {
+        std::ofstream file(output);
+        file << json.str();
+        if (!file.flush()){
+            std::cerr << "Could not write " << output << ".\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef BITS_H
+#define BITS_H
+
+#include<cstdint>
+#include<cstddef>
+
+#ifdef _MSC_VER
+#include<intrin.h>
+#endif
+
+// Index of the lowest set bit of x. (x must not be 0)
+inline int lowest_bit(uint64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    int index = 0;
+    while (!(x & 1)){
+        x >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Number of set bits in x
+inline int count_bits(uint64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (int)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Does this machine store numbers lowest byte first? (The files of MazeFile.h and MazeGraph.h need it)
+inline bool little_endian(){
+    const uint16_t one = 1;
+    return *reinterpret_cast<const uint8_t*>(&one) == 1;
+}
+
+/* Calls visit(i) for each set bit i of the bits stored 64 to a word at bits, lowest first.
+ * words is the number of words to look at.
+ */
+template<class Visit>
+void for_each_bit(const uint64_t *bits, std::size_t words, Visit visit){
+    for (std::size_t word = 0; word < words; word++){
+        for (uint64_t x = bits[word]; x != 0; x &= x - 1){
+            visit(word * 64 + lowest_bit(x));
+        }
+    }
+}
+
+#endif // BITS_H
@@ -0,0 +1,80 @@
+#ifndef BUILDSTATS_H
+#define BUILDSTATS_H
+
+#include<cstdint>
+#include<chrono>
+#include<iostream>
+
+/* Counters and phase times of a maze build, for profiling large builds without a profiler.
+ *
+ * They are only recorded when the library is compiled with MAZE_INSTRUMENT defined
+ * (cmake -DMAZE_INSTRUMENT=ON). Otherwise the MAZE_COUNT, MAZE_PEAK and MAZE_TIME macros
+ * compile to nothing, and every field stays 0.
+ */
+struct BuildStats
+{
+    static const bool ENABLED;
+
+    // Wall time of each phase, in seconds
+    double total;       // The whole build
+    double reset;       // Putting every wall up
+    double draw;        // Random decisions of each row
+    double east;        // Passages EAST
+    double south;       // Passages SOUTH
+    double pick;        // Passages SOUTH or UP that keep each set connected
+    double emit;        // Walls of each finished row, handed to the sink
+    double advance;     // Rooms of the floor above replacing the finished row
+    double compact;     // Renumbering the sets
+
+    // Counters
+    uint64_t rows;              // Rows carved
+    uint64_t finds;             // Set lookups
+    uint64_t set_merges;        // Sets joined
+    uint64_t sets_created;
+    uint64_t compactions;
+    uint64_t sets_dropped;      // Sets without live rooms, dropped by compactions
+    uint64_t passages_east;
+    uint64_t passages_south;
+    uint64_t passages_up;
+
+    // Largest sizes
+    uint64_t peak_sets;         // Sets in the disjoint set
+    uint64_t peak_row_sets;     // Different sets in one row
+
+    BuildStats(){ clear(); }
+
+    void clear();
+
+    // Adds the counters and times of other (peaks are the larger of the two)
+    void add(const BuildStats &other);
+
+    // Writes the stats as a JSON object
+    void write_json(std::ostream &out) const;
+
+    // Adds the time from its construction to its destruction to seconds
+    class Timer
+    {
+        public:
+            explicit Timer(double &s) : seconds(s), start(std::chrono::steady_clock::now()) {}
+            ~Timer(){ seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+        private:
+            double &seconds;
+            std::chrono::steady_clock::time_point start;
+    };
+};
+
+#define MAZE_STATS_JOIN2(a, b) a##b
+#define MAZE_STATS_JOIN(a, b) MAZE_STATS_JOIN2(a, b)
+
+#ifdef MAZE_INSTRUMENT
+#define MAZE_COUNT(counter, n)      ((counter) += (n))
+#define MAZE_PEAK(peak, value)      ((peak) = (uint64_t)(value) > (peak) ? (uint64_t)(value) : (peak))
+#define MAZE_TIME(seconds)          BuildStats::Timer MAZE_STATS_JOIN(maze_timer_, __LINE__)(seconds)
+#else
+#define MAZE_COUNT(counter, n)      ((void)0)
+#define MAZE_PEAK(peak, value)      ((void)0)
+#define MAZE_TIME(seconds)          ((void)0)
+#endif
+
+#endif // BUILDSTATS_H
@@ -0,0 +1,74 @@
+#ifndef DISJOINTSET_H
+#define DISJOINTSET_H
+
+#include<vector>
+#include<cstdint>
+#include<utility>
+class DisjointSet
+{
+    /* Union-find over contiguous arrays.
+     *
+     * Elements are numbered 0, 1, 2, ... in the order they are added.
+     * find() halves the path it walks, and join() unites by rank,
+     * so any sequence of operations runs in near-linear time.
+     */
+    public:
+        DisjointSet();
+        explicit DisjointSet(std::size_t);
+
+        // Removes all elements, and makes room for capacity elements.
+        void reset(std::size_t capacity);
+
+        std::size_t size() const { return parent.size(); }
+
+        // Adds an element in a set of its own. Returns the element.
+        uint32_t add(){
+            uint32_t id = parent.size();
+            parent.push_back(id);
+            rank.push_back(0);
+            return id;
+        }
+
+        // Returns the representative (root) of the set id belongs to.
+        uint32_t find(uint32_t id){
+            while (parent[id] != id){
+                parent[id] = parent[parent[id]];
+                id = parent[id];
+            }
+            return id;
+        }
+
+        // Joins the sets with roots a and b. Returns the root of the joined set.
+        uint32_t join(uint32_t a, uint32_t b){
+            if (rank[a] < rank[b]){
+                std::swap(a, b);
+            }
+            parent[b] = a;
+            if (rank[a] == rank[b]){
+                rank[a]++;
+            }
+            return a;
+        }
+
+        // Joins the sets of a and b. Returns false if they already were the same set.
+        bool unite(uint32_t a, uint32_t b){
+            a = find(a);
+            b = find(b);
+            if (a == b){
+                return false;
+            }
+            join(a, b);
+            return true;
+        }
+
+        virtual ~DisjointSet();
+
+    protected:
+
+    private:
+        // Variables
+        std::vector<uint32_t> parent;
+        std::vector<uint8_t>  rank;
+};
+
+#endif // DISJOINTSET_H
@@ -0,0 +1,350 @@
+#ifndef ELLERROWS_H
+#define ELLERROWS_H
+
+#include<algorithm>
+#include<array>
+#include<vector>
+#include<cstdint>
+#include "MazeRandom.h"
+#include "BuildStats.h"
+#include "Bits.h"
+
+// The working arrays of EllerRows in std::vectors, sized when each maze starts (MazeStream)
+struct EllerVectors
+{
+    std::vector<uint32_t> frontier;     // Set of the live room at each (row, col) position
+    std::vector<uint32_t> parent;       // Disjoint sets of the live rooms
+    std::vector<uint8_t>  rank;
+    std::vector<uint32_t> live;         // Number of live rooms in each set (valid for roots)
+    std::vector<uint32_t> scratch;
+    std::vector<uint32_t> pick;
+    std::vector<uint32_t> row_sets;
+
+    // Passages of the current row
+    std::vector<uint8_t> east_open;
+    std::vector<uint8_t> south_open;
+    std::vector<uint8_t> up_open;
+
+    // Random decisions of the current row, made for the whole row at once
+    std::vector<uint64_t> east_chances;     // Bit per room: Try a passage EAST?
+    std::vector<uint64_t> south_chances;    // Bit per room: Try a passage SOUTH?
+    std::vector<uint32_t> pick_draws;
+
+    void size(std::size_t length, std::size_t rooms, std::size_t capacity){
+        frontier.resize(rooms);
+        parent.resize(capacity);
+        rank.resize(capacity);
+        live.resize(capacity);
+        scratch.resize(capacity);
+        pick.resize(capacity);
+        row_sets.resize(length);
+        east_open.resize(length);
+        south_open.resize(length);
+        up_open.resize(length);
+        east_chances.resize((length + 63) / 64);
+        south_chances.resize((length + 63) / 64);
+        pick_draws.resize(length);
+    }
+};
+
+// The same arrays in std::arrays, for floors of L * W rooms known at compile time (FixedMaze)
+template<int L, int W>
+struct EllerArrays
+{
+    static constexpr std::size_t ROOMS = (std::size_t)L*W;
+    static constexpr std::size_t CAPACITY = 2*ROOMS + L;
+    static constexpr std::size_t WORDS = (L + 63) / 64;
+
+    std::array<uint32_t, ROOMS> frontier;
+    std::array<uint32_t, CAPACITY> parent;
+    std::array<uint8_t,  CAPACITY> rank;
+    std::array<uint32_t, CAPACITY> live;
+    std::array<uint32_t, CAPACITY> scratch;
+    std::array<uint32_t, CAPACITY> pick;
+    std::array<uint32_t, L> row_sets;
+
+    std::array<uint8_t, L> east_open;
+    std::array<uint8_t, L> south_open;
+    std::array<uint8_t, L> up_open;
+
+    std::array<uint64_t, WORDS> east_chances;
+    std::array<uint64_t, WORDS> south_chances;
+    std::array<uint32_t, L> pick_draws;
+
+    void size(std::size_t, std::size_t, std::size_t){}
+};
+
+template<class Storage>
+class EllerRows : public Storage
+{
+    /* The row kernel of the modified Eller's algorithm (see MazeStream::generate).
+     *
+     * MazeStream and FixedMaze both build their mazes with it, so they always make the same maze,
+     * whichever storage (EllerVectors or EllerArrays) holds its working arrays.
+     *
+     * For each maze: start(), then for each row, lowest floor first and NORTH to SOUTH:
+     *      carve_row() - Decides east_open, south_open and up_open of the row's rooms.
+     *      (read the passages)
+     *      advance_row() - Replaces the rooms of the row with the rooms above.
+     */
+    public:
+        EllerRows(int columns, int rows, int floors, uint32_t east_limit, uint32_t south_limit, uint64_t seed)
+            : LENGTH(columns), WIDTH(rows), HEIGHT(floors), EAST_LIMIT(east_limit), SOUTH_LIMIT(south_limit),
+              random(seed), set_count(0)
+        {
+        }
+
+        int LENGTH;
+        int WIDTH;
+        int HEIGHT;
+
+        // Counters and phase times (only recorded with MAZE_INSTRUMENT, see BuildStats.h)
+        BuildStats stats;
+
+        void reseed(uint64_t seed){ random = MazeRandom(seed); }
+
+        // The thresholds of the draws for passages EAST and SOUTH (see MazeRandom::threshold)
+        void limits(uint32_t east_limit, uint32_t south_limit){
+            EAST_LIMIT  = east_limit;
+            SOUTH_LIMIT = south_limit;
+        }
+
+        // Number of sets in use
+        std::size_t sets() const { return set_count; }
+
+        // Gives every room of the first floor a set of its own.
+        void start(){
+            std::size_t rooms = (std::size_t)LENGTH * WIDTH;
+            this->size(LENGTH, rooms, capacity());
+
+            set_count = 0;
+            for (std::size_t i = 0; i < rooms; i++){
+                this->frontier[i] = new_set();
+            }
+            std::fill(this->scratch.begin(), this->scratch.end(), NO_SET);
+        }
+
+        void carve_row(int row, int floor){
+            /* Decides the EAST, SOUTH and UP passages of the rooms in this row.
+             * Each random decision is drawn from the room's own number, see MazeRandom.
+             */
+            if (set_count + LENGTH > capacity()){
+                compact_sets();
+            }
+
+            uint64_t first_room = (uint64_t)LENGTH*row + (uint64_t)LENGTH*WIDTH*floor;
+            uint32_t *live_sets = &this->frontier[(std::size_t)LENGTH*row];
+            uint32_t *south = (row < WIDTH - 1) ? &this->frontier[(std::size_t)LENGTH*(row + 1)] : nullptr;
+
+            bool last_floor = (floor == HEIGHT - 1);
+
+            std::fill(this->east_open.begin(), this->east_open.end(), 0);
+            std::fill(this->south_open.begin(), this->south_open.end(), 0);
+            std::fill(this->up_open.begin(), this->up_open.end(), 0);
+
+            // On the last row on the last floor, all sets must be joined
+            if (last_floor && south == nullptr){
+                MAZE_TIME(stats.east);
+                for (int col = 0; col < LENGTH - 1; col++){
+                    uint32_t room_set = find(live_sets[col]);
+                    uint32_t east_set = find(live_sets[col + 1]);
+
+                    if (room_set != east_set){
+                        join_sets(room_set, east_set);
+                        this->east_open[col] = 1;
+                        MAZE_COUNT(stats.passages_east, 1);
+                    }
+                }
+                return;
+            }
+
+            // Draw the decisions of the whole row at once (see MazeRandom::chances)
+            std::size_t words = (LENGTH + 63) / 64;
+            {
+                MAZE_TIME(stats.draw);
+                this->east_chances[words - 1] = 0;      // Only the words of LENGTH - 1 rooms are drawn
+                random.chances(first_room, MazeRandom::EAST_DRAW, EAST_LIMIT, LENGTH - 1, this->east_chances.data());
+                if (south != nullptr){
+                    random.chances(first_room, MazeRandom::SOUTH_DRAW, SOUTH_LIMIT, LENGTH, this->south_chances.data());
+                }
+                random.draws(first_room, MazeRandom::PICK_DRAW, LENGTH, this->pick_draws.data());
+            }
+
+            // Try and make passages east
+            {
+                MAZE_TIME(stats.east);
+                for_each_bit(this->east_chances.data(), words, [&](std::size_t col){
+                    uint32_t room_set = find(live_sets[col]);
+                    uint32_t east_set = find(live_sets[col + 1]);
+
+                    if (room_set != east_set){
+                        join_sets(room_set, east_set);
+                        this->east_open[col] = 1;
+                        MAZE_COUNT(stats.passages_east, 1);
+                    }
+                });
+            }
+
+            // Try and make passages south
+            if (south != nullptr){
+                MAZE_TIME(stats.south);
+                for_each_bit(this->south_chances.data(), words, [&](std::size_t col){
+                    uint32_t room_set  = find(live_sets[col]);
+                    uint32_t south_set = find(south[col]);
+
+                    if (room_set != south_set){
+                        join_sets(room_set, south_set);
+                        this->south_open[col] = 1;
+                        MAZE_COUNT(stats.passages_south, 1);
+                    }
+                });
+            }
+
+            // Count the rooms of each set in this row, and pick a random room from each.
+            // (The room with the lowest draw, so the pick does not depend on the order of the rooms)
+            MAZE_TIME(stats.pick);
+            auto &row_count = this->scratch;
+            std::size_t set_total = 0;
+            for (int col = 0; col < LENGTH; col++){
+                uint32_t room_set = find(live_sets[col]);
+
+                if (row_count[room_set] == NO_SET){
+                    row_count[room_set] = 0;
+                    this->row_sets[set_total++] = room_set;
+                    this->pick[room_set] = col;
+                }
+                row_count[room_set]++;
+
+                if (this->pick_draws[col] < this->pick_draws[this->pick[room_set]]){
+                    this->pick[room_set] = col;
+                }
+            }
+            MAZE_PEAK(stats.peak_row_sets, set_total);
+
+            // Sets with all their live rooms in this row must continue SOUTH or UP
+            for (std::size_t s = 0; s < set_total; s++){
+                uint32_t room_set = this->row_sets[s];
+
+                if (this->live[room_set] == row_count[room_set]){
+                    int col = this->pick[room_set];
+                    bool go_up = !last_floor && (south == nullptr || (random(first_room + col, MazeRandom::UP_DRAW) & 1));
+
+                    if (go_up){
+                        this->up_open[col] = 1;
+                        MAZE_COUNT(stats.passages_up, 1);
+                    } else {
+                        join_sets(room_set, find(south[col]));
+                        this->south_open[col] = 1;
+                        MAZE_COUNT(stats.passages_south, 1);
+                    }
+                }
+                row_count[room_set] = NO_SET;
+            }
+        }
+
+        void advance_row(int row, int floor){
+            // Replace the rooms of this row with the rooms above.
+            MAZE_TIME(stats.advance);
+
+            uint32_t *live_sets = &this->frontier[(std::size_t)LENGTH*row];
+            for (int col = 0; col < LENGTH; col++){
+                this->live[find(live_sets[col])]--;
+
+                if (floor == HEIGHT - 1){
+                    continue;
+                }
+                if (this->up_open[col]){
+                    // Same set as the room below
+                    this->live[find(live_sets[col])]++;
+                } else {
+                    live_sets[col] = new_set();
+                }
+            }
+        }
+
+    protected:
+
+    private:
+        static constexpr uint32_t NO_SET = UINT32_MAX;
+
+        // Variables
+        uint32_t EAST_LIMIT;
+        uint32_t SOUTH_LIMIT;
+        MazeRandom random;
+        std::size_t set_count;
+
+        // Methods
+        // The number of sets is kept below capacity by compact_sets()
+        std::size_t capacity() const { return 2 * (std::size_t)LENGTH * WIDTH + LENGTH; }
+
+        uint32_t new_set(){
+            // Creates a set with a single live room
+            uint32_t id = set_count++;
+            this->parent[id] = id;
+            this->rank[id] = 0;
+            this->live[id] = 1;
+            MAZE_COUNT(stats.sets_created, 1);
+            return id;
+        }
+
+        uint32_t find(uint32_t id){
+            // The root of the set, halving the path walked (as DisjointSet::find)
+            MAZE_COUNT(stats.finds, 1);
+            while (this->parent[id] != id){
+                this->parent[id] = this->parent[this->parent[id]];
+                id = this->parent[id];
+            }
+            return id;
+        }
+
+        uint32_t join_sets(uint32_t a, uint32_t b){
+            // Joins the sets with roots a and b by rank, and their live room counts. Returns the new root.
+            MAZE_COUNT(stats.set_merges, 1);
+            if (this->rank[a] < this->rank[b]){
+                std::swap(a, b);
+            }
+            this->parent[b] = a;
+            if (this->rank[a] == this->rank[b]){
+                this->rank[a]++;
+            }
+            this->live[a] += this->live[b];
+            return a;
+        }
+
+        void compact_sets(){
+            /* Renumbers the sets of the live rooms to 0, 1, 2, ...
+             * Sets without live rooms can never be joined again, and are dropped.
+             */
+            MAZE_TIME(stats.compact);
+            MAZE_COUNT(stats.compactions, 1);
+            MAZE_PEAK(stats.peak_sets, set_count);
+
+            uint32_t count = 0;
+            for (auto &id : this->frontier){
+                uint32_t root = find(id);
+                if (this->scratch[root] == NO_SET){
+                    this->scratch[root] = count++;
+                }
+                id = this->scratch[root];
+            }
+            std::fill(this->scratch.begin(), this->scratch.begin() + set_count, NO_SET);
+            MAZE_COUNT(stats.sets_dropped, set_count - count);
+
+            for (uint32_t id = 0; id < count; id++){
+                this->parent[id] = id;
+                this->rank[id] = 0;
+                this->live[id] = 0;
+            }
+            set_count = count;
+            for (auto id : this->frontier){
+                this->live[id]++;
+            }
+        }
+};
+
+template<class Storage> constexpr uint32_t EllerRows<Storage>::NO_SET;
+template<int L, int W> constexpr std::size_t EllerArrays<L, W>::ROOMS;
+template<int L, int W> constexpr std::size_t EllerArrays<L, W>::CAPACITY;
+template<int L, int W> constexpr std::size_t EllerArrays<L, W>::WORDS;
+
+#endif // ELLERROWS_H
@@ -0,0 +1,155 @@
+#ifndef FIXEDMAZE_H
+#define FIXEDMAZE_H
+
+#include<algorithm>
+#include<array>
+#include<cassert>
+#include<cstdint>
+#include<memory>
+#include<stdexcept>
+#include "Maze.h"
+#include "MazeRandom.h"
+#include "PackedWalls.h"
+#include "EllerRows.h"
+template<int L, int W, int H>
+class FixedMaze
+{
+    /* A maze with its size fixed at compile time.
+     *
+     * Builds exactly the same maze as Maze(L, W, H, horizontal_bias, vertical_bias, seed),
+     * and stores the walls in the same blocks (see PackedWalls), but in a std::array:
+     * all index math is constant, and neither the maze nor build() allocates memory.
+     *
+     * The build state (one floor of room sets) is part of the object, so a FixedMaze
+     * with large floors is better kept static or on the heap than on the stack.
+     *
+     * Rooms are only bounds checked in debug builds (assert). Use contains() to check.
+     */
+    static_assert(L > 0 && W > 0 && H > 0, "A maze must have dimensions greater than zero.");
+    static_assert((uint64_t)L * W <= (UINT32_MAX - 1) / 3, "A maze floor can have at most 1431655764 rooms.");
+
+    public:
+        static constexpr int LENGTH = L;
+        static constexpr int WIDTH  = W;
+        static constexpr int HEIGHT = H;
+
+        // Distance between a room's index and the index of the room above (as PackedWalls::floor_stride)
+        static constexpr std::size_t FLOOR_STRIDE = ((std::size_t)L*W + 63) & ~(std::size_t)63;
+        static constexpr std::size_t WORDS = FLOOR_STRIDE / 64 * 3 * H;
+
+        // Index steps to the neighbouring rooms
+        static constexpr std::size_t EAST_STEP  = 1;
+        static constexpr std::size_t SOUTH_STEP = L;
+        static constexpr std::size_t UP_STEP    = FLOOR_STRIDE;
+
+        FixedMaze(double horizontal_bias, double vertical_bias, uint64_t seed = MazeRandom::random_seed())
+            : eller(L, W, H, 0, 0, seed)
+        {
+            // As the Maze constructor, without the dimensions.
+            if (horizontal_bias <= 0 || horizontal_bias >= 1 || vertical_bias <= 0 || vertical_bias >= 1){
+                throw std::invalid_argument("Biases must be between 0 and 1 exclusive.\n");
+            }
+            eller.limits(MazeRandom::threshold(horizontal_bias), MazeRandom::threshold(vertical_bias));
+            HORIZONTAL_BIAS = horizontal_bias;
+            VERTICAL_BIAS = vertical_bias;
+            SEED = seed;
+            walls.fill(~uint64_t(0));
+        }
+
+        uint64_t SEED;
+
+        static constexpr bool contains(int row, int col, int floor){
+            return row >= 0 && row < W && col >= 0 && col < L && floor >= 0 && floor < H;
+        }
+
+        static constexpr std::size_t index(int row, int col, int floor){
+            return col + (std::size_t)L*row + FLOOR_STRIDE*floor;
+        }
+
+        // Is the wall (PackedWalls::EAST_WORD, SOUTH_WORD or CEIL_WORD) of the room at index up?
+        bool wall(int word, std::size_t i) const {
+            return PackedWalls::block_wall(walls.data(), word, i);
+        }
+
+        // The walls of the room at (row, col, floor), as bits (Maze::FLOOR, Maze::EAST, ...).
+        int operator()(int row, int col, int floor) const {
+            assert(contains(row, col, floor));
+            return PackedWalls::room_walls([this](int word, uint64_t i){ return wall(word, i); },
+                                           index(row, col, floor), row, col, floor, SOUTH_STEP, UP_STEP);
+        }
+
+        // The raw blocks, laid out as PackedWalls::data()
+        const std::array<uint64_t, WORDS> &data() const { return walls; }
+
+        /* The same walls, without copying, as a read-only PackedWalls or as a Maze
+         * (for MazeSolver, MazeAnalysis, MazeIndex, MazeGraph, ...).
+         * Both are views of this maze: They must not outlive it, and show its latest build().
+         */
+        PackedWalls packed() const {
+            PackedWalls view;
+            view.view(L, W, H, walls.data(), owner());
+            return view;
+        }
+        Maze maze() const {
+            return Maze::view(L, W, H, HORIZONTAL_BIAS, VERTICAL_BIAS, SEED, walls.data(), owner());
+        }
+
+        // As Maze::print and Maze::save
+        void print(std::ostream &out = std::cout, unsigned threads = 1) const { maze().print(out, threads); }
+        void print(int fd, unsigned threads = 1) const { maze().print(fd, threads); }
+        void save(const std::string &path) const { maze().save(path); }
+
+        void build(){
+            /* Generates the maze, with the row kernel of MazeStream (see EllerRows),
+             * opening the walls straight in the blocks.
+             */
+            walls.fill(~uint64_t(0));
+            eller.start();
+
+            for (int floor = 0; floor < H; floor++){
+                for (int row = 0; row < W; row++){
+                    eller.carve_row(row, floor);
+
+                    std::size_t i = index(row, 0, floor);
+                    for (int col = 0; col < L; col++){
+                        if (eller.east_open[col])   open(PackedWalls::EAST_WORD, i + col);
+                        if (eller.south_open[col])  open(PackedWalls::SOUTH_WORD, i + col);
+                        if (eller.up_open[col])     open(PackedWalls::CEIL_WORD, i + col);
+                    }
+
+                    eller.advance_row(row, floor);
+                }
+            }
+        }
+
+    protected:
+
+    private:
+        // Variables
+        double HORIZONTAL_BIAS;
+        double VERTICAL_BIAS;
+        std::array<uint64_t, WORDS> walls;
+        EllerRows<EllerArrays<L, W>> eller;     // Build state: One floor of room sets, as in MazeStream
+
+        // Methods
+        // Views keep nothing alive: the maze owns the blocks
+        std::shared_ptr<const void> owner() const {
+            return std::shared_ptr<const void>(this, [](const void*){});
+        }
+
+        void open(int word, std::size_t i){
+            walls[(i >> 6)*3 + word] &= ~(uint64_t(1) << (i & 63));
+        }
+};
+
+// Definitions of the constants (needed when they are bound to references before C++17)
+template<int L, int W, int H> constexpr int FixedMaze<L, W, H>::LENGTH;
+template<int L, int W, int H> constexpr int FixedMaze<L, W, H>::WIDTH;
+template<int L, int W, int H> constexpr int FixedMaze<L, W, H>::HEIGHT;
+template<int L, int W, int H> constexpr std::size_t FixedMaze<L, W, H>::FLOOR_STRIDE;
+template<int L, int W, int H> constexpr std::size_t FixedMaze<L, W, H>::WORDS;
+template<int L, int W, int H> constexpr std::size_t FixedMaze<L, W, H>::EAST_STEP;
+template<int L, int W, int H> constexpr std::size_t FixedMaze<L, W, H>::SOUTH_STEP;
+template<int L, int W, int H> constexpr std::size_t FixedMaze<L, W, H>::UP_STEP;
+
+#endif // FIXEDMAZE_H
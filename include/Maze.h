@@ -1,46 +1,110 @@
-#ifndef MAZE_H
-#define MAZE_H
-
-#include<vector>
-#include<iostream>
-class Maze
-{
-    public:
-        Maze(int, int, int, double, double);
-
-        int LENGTH;
-        int WIDTH;
-        int HEIGHT;
-
-        static const uint8_t FLOOR     =  1;   // 00 00 00 01;
-        static const uint8_t EAST      =  2;   // 00 00 00 10;
-        static const uint8_t NORTH     =  4;   // 00 00 01 00;
-        static const uint8_t WEST      =  8;   // 00 00 10 00;
-        static const uint8_t SOUTH     = 16;   // 00 01 00 00;
-        static const uint8_t CEIL      = 32;   // 00 10 00 00;
-
-        std::vector<int> cell_data;
-
-        int &operator()(int row, int col, int floor){
-            return cell_data.at(col + LENGTH*row + LENGTH*WIDTH*floor);
-        }
-        void build();
-        void print();
-        virtual ~Maze();
-
-    protected:
-
-    private:
-        // Variables
-        double EAST_WALL_THRESHOLD;
-        double SOUTH_WALL_THRESHOLD;
-        std::vector< std::tuple<int, int, int, int, int, int> > passages;
-        typedef std::tuple<int, int, int> pos;
-
-        // Methods
-        int get_val(int, int, int);
-        void set_val(int, int, int, int);
-        void calc_cell_values();
-};
-
-#endif // MAZE_H
+#ifndef MAZE_H
+#define MAZE_H
+
+#include<vector>
+#include<string>
+#include<iostream>
+#include<functional>
+#include<stdexcept>
+#include "PackedWalls.h"
+#include "MazeRandom.h"
+#include "BuildStats.h"
+class DisjointSet;
+class MazeGenerator;
+class Maze
+{
+    public:
+        Maze(int, int, int, double, double, uint64_t seed = MazeRandom::random_seed());
+
+        int LENGTH;
+        int WIDTH;
+        int HEIGHT;
+        uint64_t SEED;
+        bool EDITED;    // Carved again in places by regenerate() since the last build, so SEED alone no longer gives these walls
+
+        static const uint8_t FLOOR     =  1;   // 00 00 00 01;
+        static const uint8_t EAST      =  2;   // 00 00 00 10;
+        static const uint8_t NORTH     =  4;   // 00 00 01 00;
+        static const uint8_t WEST      =  8;   // 00 00 10 00;
+        static const uint8_t SOUTH     = 16;   // 00 01 00 00;
+        static const uint8_t CEIL      = 32;   // 00 10 00 00;
+
+        struct Room {
+            int row, col, floor;
+        };
+
+        // The walls of the room at (row, col, floor), as bits (Maze::FLOOR, Maze::EAST, ...).
+        int operator()(int row, int col, int floor) const {
+            if (row < 0 || row >= WIDTH || col < 0 || col >= LENGTH || floor < 0 || floor >= HEIGHT){
+                throw std::out_of_range("Room is outside the maze.\n");
+            }
+            return wall_data.room_walls(row, col, floor);
+        }
+
+        // The stored walls (EAST, SOUTH and CEIL of each room)
+        const PackedWalls &packed() const { return wall_data; }
+
+        void build();
+        void build(const MazeGenerator &generator);
+        void build_parallel(unsigned threads = 0);
+
+        // Carves the box of rooms starting at (row, col, floor) again, keeping the maze perfect.
+        // Returns the rooms whose walls changed, and sets EDITED. (See MazeRegion.cpp)
+        std::vector<Room> regenerate(int row, int col, int floor, int rows, int columns, int floors, uint64_t seed);
+
+        // Counters and phase times of the last build (only recorded with MAZE_INSTRUMENT, see BuildStats.h).
+        // The counters come from build() and the eller generator; other builds record the times of the whole build.
+        const BuildStats &stats() const { return last_build; }
+
+        // Draws the maze as text, using up to threads threads (0 = one per hardware thread)
+        void print(std::ostream &out = std::cout, unsigned threads = 1) const;
+        void print(int fd, unsigned threads = 1) const;
+
+        // Binary maze files (see MazeFile.h)
+        void save(const std::string &path) const;
+        static Maze open(const std::string &path, bool verify = false);
+
+        // A maze reading the wall blocks at blocks (laid out as PackedWalls::data()) without copying.
+        // owner keeps them alive. Throws std::invalid_argument as the constructor. (See FixedMaze::maze)
+        static Maze view(int columns, int rows, int floors, double horizontal_bias, double vertical_bias, uint64_t seed,
+                         const uint64_t *blocks, std::shared_ptr<const void> owner);
+
+        // Builds the maze build() would, straight into a maze file, one floor at a time.
+        // Floors are written while the next ones are generated (see MazePipeline).
+        // Memory holds one floor (about 40 bytes per room of a floor), whatever the number of floors.
+        // Returns the checksum of the walls. (Read the file with Maze::open or PagedMaze)
+        static uint64_t build_to_file(const std::string &path, int columns, int rows, int floors,
+                                      double horizontal_bias, double vertical_bias, uint64_t seed = MazeRandom::random_seed());
+        virtual ~Maze();
+
+    protected:
+
+    private:
+        Maze();
+
+        // The areas (trees) of a floor carved on its own (see MazeParallel.cpp)
+        struct FloorAreas {
+            std::vector<uint32_t> labels;       // Area of each room of the floor
+            std::vector<uint32_t> pick_room;    // Room with the lowest PICK_DRAW of each area
+            std::vector<uint32_t> pick_draw;
+            std::size_t count;
+        };
+
+        // Variables
+        double EAST_WALL_THRESHOLD;
+        double SOUTH_WALL_THRESHOLD;
+        PackedWalls wall_data;
+        BuildStats last_build;
+
+        // Methods
+        void carve_floor(int, DisjointSet&, FloorAreas&, std::vector<uint32_t>&);
+        void render(unsigned, const std::function<void(const char*, std::size_t)>&) const;
+        std::size_t render_rows(int, int, int, char*) const;
+};
+
+// Maze::operator() hands out PackedWalls::room_walls() as it is
+static_assert(Maze::FLOOR == PackedWalls::FLOOR_BIT && Maze::EAST == PackedWalls::EAST_BIT && Maze::NORTH == PackedWalls::NORTH_BIT
+              && Maze::WEST == PackedWalls::WEST_BIT && Maze::SOUTH == PackedWalls::SOUTH_BIT && Maze::CEIL == PackedWalls::CEIL_BIT,
+              "The wall bits of Maze and PackedWalls must agree.");
+
+#endif // MAZE_H
@@ -0,0 +1,53 @@
+#ifndef MAZEANALYSIS_H
+#define MAZEANALYSIS_H
+
+#include<cstdint>
+#include<iostream>
+#include "Maze.h"
+class MazeAnalysis
+{
+    /* Checks that a maze is perfect (every room reaches every other room, by exactly one path),
+     * and measures its shape.
+     *
+     * The passages are counted in one sweep over the wall bits, 64 rooms at a time.
+     * Connectivity and the longest path take two breadth first searches (see MazeSolver::farthest),
+     * and a maze that is not connected one more, to count its parts.
+     * Nothing is allocated per room beyond the search space of the solver (about 4 bytes per room).
+     */
+    public:
+        explicit MazeAnalysis(const Maze &);
+
+        uint64_t rooms;
+        uint64_t passages;          // Open walls between two rooms (stairs included)
+        uint64_t stairs;            // Passages between floors
+        uint64_t degree[7];         // Number of rooms with 0, 1, ... 6 passages
+        uint64_t dead_ends;         // Rooms with one passage
+        uint64_t junctions;         // Rooms with three passages or more
+        uint64_t outer_openings;    // Open outer walls (never in a valid maze)
+        uint64_t components;        // Separate parts of the maze
+
+        bool connected;
+        bool acyclic;
+
+        // The longest path, and its ends (row, col, floor).
+        // Exact for perfect mazes. Otherwise a path in the part of the first room, as long as found.
+        uint64_t diameter;
+        int diameter_from[3];
+        int diameter_to[3];
+
+        bool perfect() const { return connected && acyclic && outer_openings == 0; }
+
+        // Writes the results as a JSON object.
+        void write_json(std::ostream &out) const;
+
+        virtual ~MazeAnalysis();
+
+    protected:
+
+    private:
+        // Methods
+        void sweep(const PackedWalls &);
+        void count_outer_openings(const PackedWalls &);
+};
+
+#endif // MAZEANALYSIS_H
@@ -0,0 +1,70 @@
+#ifndef MAZEBATCH_H
+#define MAZEBATCH_H
+
+#include<vector>
+#include<cstdint>
+#include "Maze.h"
+#include "MazeStream.h"
+#include "ParallelFor.h"
+class MazeBatch
+{
+    /* Generates many mazes of one shape at once.
+     *
+     * All mazes are stored one after another in a single block of memory (the arena),
+     * each as the wall blocks of a Maze of the same size and seed (see PackedWalls).
+     * Maze number i is the same maze as Maze(columns, rows, floors, horizontal_bias, vertical_bias, seeds[i]).build().
+     *
+     * The mazes are spread over a pool of threads kept by the batch (see WorkerPool), and each thread
+     * reuses one MazeStream, so once the arena, the pool and the streams have grown to size,
+     * generating neither creates threads nor allocates.
+     */
+    public:
+        MazeBatch(int, int, int, double, double);
+        MazeBatch(const MazeBatch &) = delete;
+        MazeBatch &operator=(const MazeBatch &) = delete;
+
+        int LENGTH;
+        int WIDTH;
+        int HEIGHT;
+
+        // Generates one maze per seed, replacing the mazes from before.
+        // Uses up to threads threads (0 = one per hardware thread).
+        void generate(const uint64_t *seeds, std::size_t count, unsigned threads = 0);
+        void generate(const std::vector<uint64_t> &seeds, unsigned threads = 0){
+            generate(seeds.data(), seeds.size(), threads);
+        }
+
+        // Number of mazes
+        std::size_t size() const { return SEEDS.size(); }
+        uint64_t seed(std::size_t maze) const { return SEEDS[maze]; }
+
+        // The walls of the room in maze number maze, as bits (Maze::FLOOR, Maze::EAST, ...).
+        int operator()(std::size_t maze, int row, int col, int floor) const;
+
+        // The wall blocks of maze number maze: maze_words() words, laid out as PackedWalls::data().
+        const uint64_t *data(std::size_t maze) const { return arena.data() + maze * MAZE_WORDS; }
+        std::size_t maze_words() const { return MAZE_WORDS; }
+        std::size_t floor_stride() const { return FLOOR_STRIDE; }
+
+        virtual ~MazeBatch();
+
+    protected:
+
+    private:
+        // Variables
+        double EAST_WALL_THRESHOLD;
+        double SOUTH_WALL_THRESHOLD;
+        std::size_t FLOOR_STRIDE;
+        std::size_t MAZE_WORDS;
+
+        std::vector<uint64_t> SEEDS;
+        std::vector<uint64_t> arena;
+
+        // One stream and sink per thread, and the maze each is writing
+        std::vector<MazeStream> streams;
+        std::vector<MazeStream::RowSink> sinks;
+        std::vector<uint64_t*> targets;
+        WorkerPool pool;
+};
+
+#endif // MAZEBATCH_H
@@ -0,0 +1,51 @@
+#ifndef MAZEFILE_H
+#define MAZEFILE_H
+
+#include<cstdint>
+#include<string>
+struct MazeFileHeader
+{
+    /* The first 64 bytes of a maze file (see Maze::save and Maze::open).
+     *
+     *      magic           - "MAZE3D" followed by two zero bytes.
+     *      version         - MazeFileHeader::VERSION
+     *      layout          - MazeFileHeader::LAYOUT: Blocks of 64 rooms, three words each
+     *                          (EAST, SOUTH and CEIL walls), floors padded to whole blocks. (See PackedWalls)
+     *      length, width, height, seed, horizontal_bias, vertical_bias - As given to the Maze constructor.
+     *      flags           - MazeFileHeader::EDITED if the walls were carved again in places after building
+     *                          (see Maze::regenerate), so building from the seed no longer gives them back.
+     *      checksum        - PackedWalls::checksum of all blocks.
+     *
+     * The blocks follow right after the header. All numbers are little endian,
+     * so maze files are only read and written on little endian machines (others throw std::runtime_error).
+     */
+    static const uint32_t VERSION = 1;
+    static const uint32_t LAYOUT  = 1;
+    static const uint32_t EDITED  = 1;
+
+    char     magic[8];
+    uint32_t version;
+    uint32_t layout;
+    int32_t  length;
+    int32_t  width;
+    int32_t  height;
+    uint32_t flags;
+    uint64_t seed;
+    double   horizontal_bias;
+    double   vertical_bias;
+    uint64_t checksum;
+
+    static MazeFileHeader make(int length, int width, int height, uint64_t seed,
+                               double horizontal_bias, double vertical_bias, uint64_t checksum, uint32_t flags = 0);
+
+    // Number of words of blocks after the header.
+    uint64_t data_words() const;
+
+    // Throws std::runtime_error if this is not a header of a file with file_size bytes,
+    // its dimensions or biases could not be given to the Maze constructor, or it has unknown flags.
+    void check(uint64_t file_size, const std::string &path) const;
+};
+
+static_assert(sizeof(MazeFileHeader) == 64, "The maze file header must be 64 bytes.");
+
+#endif // MAZEFILE_H
@@ -0,0 +1,86 @@
+#ifndef MAZEGENERATOR_H
+#define MAZEGENERATOR_H
+
+#include<cstdint>
+#include "PackedWalls.h"
+#include "BuildStats.h"
+class MazeGenerator
+{
+    /* A way of carving a perfect maze. (See Maze::build(const MazeGenerator&))
+     *
+     * carve() gets the walls of the maze with every wall up, and must remove walls
+     * so that there is exactly one path between any two rooms, without opening the outer walls.
+     * The same seed must always give the same maze.
+     *
+     * Generators hold no state between calls, so one generator can build many mazes at once.
+     */
+    public:
+        virtual ~MazeGenerator();
+
+        virtual const char *name() const = 0;
+
+        virtual void carve(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed) const = 0;
+
+        // carve(), recording what it can in stats (see BuildStats.h). By default nothing is recorded.
+        virtual void carve_with_stats(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed, BuildStats &stats) const;
+};
+
+class EllerGenerator : public MazeGenerator
+{
+    /* The modified Eller's algorithm of Maze::build(), one row at a time (see MazeStream).
+     * Memory is one floor of room sets.
+     * The biases set the likelihood of passages EAST and SOUTH; the rest of the passages are stairs.
+     */
+    public:
+        const char *name() const { return "eller"; }
+        void carve(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed) const;
+        void carve_with_stats(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed, BuildStats &stats) const;
+};
+
+class KruskalGenerator : public MazeGenerator
+{
+    /* Kruskal's algorithm: Every passage is tried once, in random order, and opened
+     * if it joins two sets of rooms (kept in a DisjointSet).
+     *
+     * The random order is made without storing or sorting the draws of all passages:
+     * passages are counted into buckets by the top bits of their draw, and each bucket
+     * is sorted on its own while it is used. Memory is about 17 bytes per room.
+     * Every passage is equally likely, so the biases are not used.
+     */
+    public:
+        const char *name() const { return "kruskal"; }
+        void carve(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed) const;
+};
+
+class WilsonGenerator : public MazeGenerator
+{
+    /* Wilson's algorithm: Random walks from each room not yet in the maze, until they reach it,
+     * with loops erased. Every perfect maze is equally likely (a uniform spanning tree),
+     * so the biases are not used. The walks get long for the first rooms of a large maze:
+     * this is the slowest of the generators.
+     * Memory is about 1 byte per room.
+     */
+    public:
+        const char *name() const { return "wilson"; }
+        void carve(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed) const;
+};
+
+class GrowingTreeGenerator : public MazeGenerator
+{
+    /* The growing tree algorithm, with an explicit stack of rooms to grow from.
+     * Each step grows from the newest room with probability newest, otherwise from a random one:
+     * newest = 1 is the recursive backtracker (long winding passages),
+     * newest = 0 is much like Prim's algorithm (many short dead ends).
+     * The biases are not used.
+     */
+    public:
+        explicit GrowingTreeGenerator(double newest = 1.0);
+
+        const char *name() const { return "growing_tree"; }
+        void carve(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed) const;
+
+    private:
+        uint32_t NEWEST_LIMIT;
+};
+
+#endif // MAZEGENERATOR_H
@@ -0,0 +1,70 @@
+#ifndef MAZEGRAPH_H
+#define MAZEGRAPH_H
+
+#include<vector>
+#include<string>
+#include<cstdint>
+#include "Maze.h"
+
+struct MazeGraphHeader
+{
+    /* The first 32 bytes of a graph file (see MazeGraph::save and MazeGraph::write).
+     *
+     *      magic       - "MAZECSR" followed by a zero byte.
+     *      version     - MazeGraphHeader::VERSION
+     *      index_bytes - 4 or 8: The size of each number after the header.
+     *      nodes       - Number of rooms.
+     *      entries     - Number of neighbours stored (twice the number of passages).
+     *
+     * Then come the offsets (nodes + 1 numbers), and the neighbours (entries numbers).
+     * All numbers are little endian, so graph files are only written on little endian machines
+     * (others throw std::runtime_error).
+     */
+    static const uint32_t VERSION = 1;
+
+    char     magic[8];
+    uint32_t version;
+    uint32_t index_bytes;
+    uint64_t nodes;
+    uint64_t entries;
+};
+
+static_assert(sizeof(MazeGraphHeader) == 32, "The graph file header must be 32 bytes.");
+
+template<class Index>
+class MazeGraph
+{
+    /* The passages of a maze as a graph, in compressed sparse row form.
+     *
+     * Node n is the room col + LENGTH*row + LENGTH*WIDTH*floor.
+     * Its neighbours are neighbours[offsets[n]] ... neighbours[offsets[n + 1] - 1], in increasing order
+     * (below, NORTH, WEST, EAST, SOUTH, above). Each passage is stored from both of its rooms.
+     *
+     * Read straight from the wall bits, in parallel over the floors. The outer walls must be up (as in any built maze).
+     * Index is uint32_t or uint64_t. uint32_t halves the memory, and holds up to 2^32 - 1 neighbours
+     * (and fewer rooms). A perfect maze stores two neighbours for each of its rooms but one,
+     * so that is a perfect maze of up to 2^31 rooms. Larger graphs throw std::length_error.
+     */
+    public:
+        explicit MazeGraph(const Maze &, unsigned threads = 0);
+
+        std::vector<Index> offsets;         // nodes() + 1 entries
+        std::vector<Index> neighbours;
+
+        std::size_t nodes() const { return offsets.size() - 1; }
+        std::size_t entries() const { return neighbours.size(); }
+
+        // Writes the graph as a graph file (see MazeGraphHeader).
+        void save(const std::string &path) const;
+
+        // Writes the graph of the maze as a graph file, without holding the whole graph in memory.
+        // (Each thread holds the graph of one floor)
+        static void write(const Maze &maze, const std::string &path, unsigned threads = 0);
+
+        virtual ~MazeGraph();
+};
+
+extern template class MazeGraph<uint32_t>;
+extern template class MazeGraph<uint64_t>;
+
+#endif // MAZEGRAPH_H
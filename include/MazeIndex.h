@@ -0,0 +1,89 @@
+#ifndef MAZEINDEX_H
+#define MAZEINDEX_H
+
+#include<vector>
+#include<string>
+#include<cstdint>
+#include "Maze.h"
+class MazeIndex
+{
+    /* Answers distance and route queries on a perfect maze in logarithmic time, after one linear build.
+     *
+     * A perfect maze is a tree. The index roots it at the first room, and splits it into heavy paths
+     * (each room continues the path of its largest branch). Rooms are numbered in depth first order,
+     * heavy branch first, so every branch and every heavy path is a range of numbers.
+     * Two rooms meet where their paths up do, which takes at most log2(rooms) path jumps,
+     * and the next step towards a room is the neighbour whose branch holds it.
+     *
+     * Memory is about 17 bytes per room (22 while building). Works on room indexes (see PackedWalls::index).
+     * The maze must outlive the index, and must not be rebuilt or regenerated while the index is used.
+     *
+     * The index is not incremental. The numbering is global: regenerating even a small box moves the
+     * numbers, depths and branch sizes of rooms all through the maze, so any change to the maze
+     * needs a new index (built again, and saved again as a whole).
+     */
+    public:
+        // Throws std::invalid_argument if the maze is not perfect.
+        explicit MazeIndex(const Maze &);
+
+        // Number of moves between the rooms
+        std::size_t distance(int row, int col, int floor, int to_row, int to_col, int to_floor) const;
+
+        // The first move of the path to the room (Maze::EAST, WEST, NORTH, SOUTH, CEIL or FLOOR), 0 if there already.
+        uint8_t next_step(int row, int col, int floor, int to_row, int to_col, int to_floor) const;
+
+        // All the moves of the path to the room
+        std::vector<uint8_t> path(int row, int col, int floor, int to_row, int to_col, int to_floor) const;
+
+        /* Saves the index, to open it next to the maze later without building it again.
+         * The file holds the size and the checksum of the maze's walls (see PackedWalls::checksum),
+         * so it is only ever used with the maze it was built from.
+         * The whole index is written at once (about 17 bytes per room).
+         */
+        void save(const std::string &path) const;
+
+        // Throws std::runtime_error if the file can not be read, or belongs to another maze.
+        static MazeIndex open(const std::string &path, const Maze &maze);
+
+        virtual ~MazeIndex();
+
+    protected:
+
+    private:
+        MazeIndex(const Maze &, bool);
+
+        // Variables
+        const Maze &maze;
+        const PackedWalls &walls;
+        std::size_t LENGTH;
+        std::size_t STRIDE;
+        std::size_t ROOMS;      // Including the padding at the end of each floor
+
+        std::vector<uint32_t> depth;    // Moves from the first room
+        std::vector<uint32_t> head;     // Top room of the room's heavy path
+        std::vector<uint32_t> order;    // Depth first number (tin)
+        std::vector<uint32_t> size;     // Rooms in the branch (its numbers are order .. order + size - 1)
+        std::vector<uint8_t>  up;       // Move to the room above (0 for the first room)
+
+        // Methods
+        std::size_t room(int, int, int) const;
+        std::size_t step(std::size_t, uint8_t) const;
+        std::size_t parent(std::size_t i) const { return step(i, up[i]); }
+        bool holds(std::size_t branch, std::size_t i) const { return order[i] - order[branch] < size[branch]; }
+        std::size_t meet(std::size_t, std::size_t) const;
+        uint8_t first_move(std::size_t, std::size_t) const;
+        void build();
+
+        // Calls visit(next room, move) for each passage out of room i
+        template<class Visit>
+        void neighbours(std::size_t i, Visit visit) const {
+            if (!walls.wall(PackedWalls::EAST_WORD, i))                      visit(i + 1, Maze::EAST);
+            if (i >= 1 && !walls.wall(PackedWalls::EAST_WORD, i - 1))        visit(i - 1, Maze::WEST);
+            if (!walls.wall(PackedWalls::SOUTH_WORD, i))                     visit(i + LENGTH, Maze::SOUTH);
+            if (i >= LENGTH && !walls.wall(PackedWalls::SOUTH_WORD, i - LENGTH))  visit(i - LENGTH, Maze::NORTH);
+            if (!walls.wall(PackedWalls::CEIL_WORD, i))                      visit(i + STRIDE, Maze::CEIL);
+            if (i >= STRIDE && !walls.wall(PackedWalls::CEIL_WORD, i - STRIDE))   visit(i - STRIDE, Maze::FLOOR);
+        }
+};
+
+#endif // MAZEINDEX_H
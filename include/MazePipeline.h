@@ -0,0 +1,67 @@
+#ifndef MAZEPIPELINE_H
+#define MAZEPIPELINE_H
+
+#include<atomic>
+#include<condition_variable>
+#include<deque>
+#include<exception>
+#include<mutex>
+#include<thread>
+#include<cstdint>
+#include "MazeStream.h"
+#include "PackedWalls.h"
+class MazePipeline
+{
+    /* Generates a maze on a thread of its own, handing over each floor as soon as it is finished.
+     *
+     * A floor is final once the stairs up from it are chosen, so the first floor is ready
+     * after one floor's worth of work, and rendering, saving or sending it can go on
+     * while the floors above are generated. Memory is bounded: the generator waits
+     * while queued_floors finished floors are waiting to be taken.
+     *
+     * The floors are those of Maze::build (and Maze::build_to_file) for the same seed.
+     * Floors are taken by one consumer thread. Destroying the pipeline stops the generator.
+     */
+    public:
+        MazePipeline(int, int, int, double, double, uint64_t seed = MazeRandom::random_seed(), std::size_t queued_floors = 2);
+
+        int LENGTH;
+        int WIDTH;
+        int HEIGHT;
+
+        struct Floor {
+            int number;             // 0 is the lowest floor
+            PackedWalls walls;      // The EAST, SOUTH and CEIL walls of the floor's rooms, at walls.index(row, col, 0)
+        };
+
+        /* Waits for the next floor, lowest first. Returns false once every floor has been taken.
+         * Rethrows anything the generator threw.
+         */
+        bool next(Floor &floor);
+
+        virtual ~MazePipeline();
+
+    protected:
+
+    private:
+        // Stops the generator, from inside the row sink
+        struct Stopped {};
+
+        // Variables
+        MazeStream stream;
+        std::size_t CAPACITY;
+
+        std::mutex lock;
+        std::condition_variable floor_ready;
+        std::condition_variable space_ready;
+        std::deque<Floor> finished;     // Floors waiting to be taken
+        bool done;                      // No more floors will come
+        std::exception_ptr error;
+        std::atomic<bool> stop;
+        std::thread generator;
+
+        // Methods
+        void run();
+};
+
+#endif // MAZEPIPELINE_H
@@ -0,0 +1,81 @@
+#ifndef MAZERANDOM_H
+#define MAZERANDOM_H
+
+#include<cstdint>
+#include<cstddef>
+class MazeRandom
+{
+    /* Counter-based random numbers for maze generation.
+     *
+     * Every random decision is a pure function of (seed, room, stream),
+     * where room is col + LENGTH*row + LENGTH*WIDTH*floor and stream tells the decisions of a room apart.
+     * No state is kept between draws, so any part of a maze can be generated in any order,
+     * on any thread, and always get the same decisions.
+     *
+     * The hash is two rounds of a 32 bit integer mixer (lowbias32 by Chris Wellons),
+     * keyed by a SplitMix64 scramble of the seed.
+     */
+    public:
+        explicit MazeRandom(uint64_t seed = 0);
+
+        // Streams
+        static const uint32_t EAST_DRAW  = 0;  // Remove the EASTERN wall?
+        static const uint32_t SOUTH_DRAW = 1;  // Remove the SOUTHERN wall?
+        static const uint32_t UP_DRAW    = 2;  // Go up rather than SOUTH?
+        static const uint32_t PICK_DRAW  = 3;  // Which room of a set to pick
+        static const uint32_t LINK_DRAW  = 4;  // Which neighbour a tile links to (TiledMaze)
+        static const uint32_t DOOR_DRAW  = 5;  // Where the door between two tiles is (TiledMaze)
+        static const uint32_t SEED_DRAW  = 6;  // Seed of a tile (TiledMaze, uses 6 and 7)
+        static const uint32_t ORDER_DRAW = 8;  // Order of the passages EAST, SOUTH and UP (KruskalGenerator, uses 8 to 10)
+        static const uint32_t WALK_DRAW  = 11; // Steps of a walk, by step instead of room (WilsonGenerator, GrowingTreeGenerator, uses 11 and 12)
+        static const uint32_t REGION_DRAW = 13; // Order of the walls of a regenerated region, by wall instead of room (Maze::regenerate)
+
+        uint32_t operator()(uint64_t room, uint32_t stream) const {
+            uint32_t x = mix((uint32_t)room ^ (KEY_LOW + stream * 0x9e3779b9u));
+            return mix(x ^ (uint32_t)(room >> 32) ^ KEY_HIGH);
+        }
+
+        // Is the draw below threshold? (See threshold())
+        bool chance(uint64_t room, uint32_t stream, uint32_t limit) const {
+            return (*this)(room, stream) < limit;
+        }
+
+        // The threshold a draw must be below to happen with probability p.
+        static uint32_t threshold(double p);
+
+        // The draws of count consecutive rooms: out[i] = (*this)(room + i, stream)
+        void draws(uint64_t room, uint32_t stream, std::size_t count, uint32_t *out) const;
+
+        // Sets bit i of bits (64 to a word) if chance(room + i, stream, limit), for i < count.
+        // Clears the rest of the last word.
+        void chances(uint64_t room, uint32_t stream, uint32_t limit, std::size_t count, uint64_t *bits) const;
+
+        // Are draws() and chances() using AVX2? Both give the same results either way.
+        // use_simd(false) forces the portable code, use_simd(true) uses AVX2 if the processor has it.
+        static bool simd();
+        static void use_simd(bool enable);
+
+        static uint32_t mix(uint32_t x){
+            x ^= x >> 16;
+            x *= 0x7feb352du;
+            x ^= x >> 15;
+            x *= 0x846ca68bu;
+            x ^= x >> 16;
+            return x;
+        }
+
+        // A seed that differs between calls (and runs), for when reproducibility is not needed.
+        static uint64_t random_seed();
+
+        uint64_t seed() const { return SEED; }
+
+    protected:
+
+    private:
+        // Variables
+        uint64_t SEED;
+        uint32_t KEY_LOW;
+        uint32_t KEY_HIGH;
+};
+
+#endif // MAZERANDOM_H
@@ -0,0 +1,91 @@
+#ifndef MAZESOLVER_H
+#define MAZESOLVER_H
+
+#include<vector>
+#include<cstdint>
+#include "Maze.h"
+class MazeSolver
+{
+    /* Finds shortest paths between rooms of a maze.
+     *
+     * Works straight on the packed walls of the maze, using room indexes (see PackedWalls::index).
+     * Search space (visited bits, queues, the heap and the path back) is allocated the first time
+     * a search needs it, and reused by every later search.
+     * (A breadth first search needs about 4 bytes per room, a search both ways twice that,
+     *  and a search that returns the path one more byte per room and side)
+     *
+     * The maze must outlive the solver, and must not be rebuilt while the solver is used.
+     */
+    public:
+        explicit MazeSolver(const Maze &);
+
+        struct Path {
+            bool found;                 // Is there a path at all?
+            std::size_t length;         // Number of moves
+            std::vector<uint8_t> moves; // Maze::EAST, WEST, NORTH or SOUTH, Maze::CEIL (up) or Maze::FLOOR (down)
+            std::size_t visited;        // Rooms visited by the search
+        };
+
+        // Breadth first search
+        Path bfs(int row, int col, int floor, int to_row, int to_col, int to_floor);
+
+        // Breadth first search from both ends, expanding the smaller side a level at a time
+        Path bidirectional(int row, int col, int floor, int to_row, int to_col, int to_floor);
+
+        // A* with the distance as the crow walks (rows + columns + floors apart)
+        Path astar(int row, int col, int floor, int to_row, int to_col, int to_floor);
+
+        struct Farthest {
+            int row, col, floor;        // A room as far as any from the start
+            std::size_t distance;       // Number of moves to it
+            std::size_t reached;        // Rooms that can be reached from the start (including it)
+        };
+
+        // Breadth first search through every room that can be reached from the room.
+        // In a perfect maze, the farthest room from the farthest room is an end of the longest path.
+        Farthest farthest(int row, int col, int floor);
+
+        // Number of separate parts of the maze (1 if every room can reach every other)
+        std::size_t components();
+
+        virtual ~MazeSolver();
+
+    protected:
+
+    private:
+        // Variables
+        const Maze &maze;
+        const PackedWalls &walls;
+        std::size_t LENGTH;
+        std::size_t STRIDE;
+        std::size_t ROOMS;      // Including the padding at the end of each floor
+
+        std::vector<uint64_t> seen[2];      // Visited bits, from the start and from the goal
+        std::vector<uint8_t>  came[2];      // Move into each visited room
+        std::vector<uint32_t> queue[2];
+        std::vector<uint32_t> cost;         // A*: moves from the start
+        std::vector<std::pair<uint64_t, std::size_t>> heap;
+
+        // Methods
+        std::size_t room(int, int, int) const;
+        void prepare(int, bool);
+        void clear(int);
+        std::size_t flood(std::size_t, std::size_t &, std::size_t &);
+        bool is_seen(int side, std::size_t i) const { return (seen[side][i >> 6] >> (i & 63)) & 1; }
+        void see(int side, std::size_t i){ seen[side][i >> 6] |= uint64_t(1) << (i & 63); }
+        std::size_t step_back(std::size_t, uint8_t) const;
+        void trace(int, std::size_t, std::size_t, std::vector<uint8_t>&) const;
+
+        // Calls visit(next room, move) for each passage out of room i
+        template<class Visit>
+        void neighbours(std::size_t i, Visit visit) const {
+            if (!walls.wall(PackedWalls::EAST_WORD, i))                      visit(i + 1, Maze::EAST);
+            if (i >= 1 && !walls.wall(PackedWalls::EAST_WORD, i - 1))        visit(i - 1, Maze::WEST);
+            if (!walls.wall(PackedWalls::SOUTH_WORD, i))                     visit(i + LENGTH, Maze::SOUTH);
+            if (i >= LENGTH && !walls.wall(PackedWalls::SOUTH_WORD, i - LENGTH))  visit(i - LENGTH, Maze::NORTH);
+            if (!walls.wall(PackedWalls::CEIL_WORD, i))                      visit(i + STRIDE, Maze::CEIL);
+            if (i >= STRIDE && !walls.wall(PackedWalls::CEIL_WORD, i - STRIDE))   visit(i - STRIDE, Maze::FLOOR);
+        }
+};
+
+#endif // MAZESOLVER_H
@@ -0,0 +1,71 @@
+#ifndef MAZESTREAM_H
+#define MAZESTREAM_H
+
+#include<vector>
+#include<functional>
+#include<cstdint>
+#include "EllerRows.h"
+#include "MazeRandom.h"
+#include "BuildStats.h"
+class MazeStream
+{
+    /* Streaming generator for mazes too large to keep in memory.
+     *
+     * Runs the same modified Eller's algorithm as Maze::build, but only keeps
+     * the sets of the cells that can still be reached by a new passage:
+     * one cell per (row, col) position, from either the current floor or the one above.
+     * Each row is handed to the sink as soon as all of its walls are decided,
+     * so memory use is independent of the number of floors.
+     */
+    public:
+        MazeStream(int, int, int, double, double, uint64_t seed = MazeRandom::random_seed());
+
+        int LENGTH;
+        int WIDTH;
+        int HEIGHT;
+
+        // Receives each finished row, lowest floor first and NORTH to SOUTH.
+        // walls[col] holds the remaining walls of that room (Maze::FLOOR, Maze::EAST, ...).
+        typedef std::function<void(int row, int floor, const std::vector<uint8_t> &walls)> RowSink;
+
+        void generate(const RowSink &sink);
+
+        // Makes the next generate() build the maze of another seed.
+        // The working memory is kept, so generating many mazes of one size only allocates once.
+        void reseed(uint64_t seed){ eller.reseed(seed); }
+
+        // Writes the rooms' wall values to out, in the order of index col + LENGTH*row + LENGTH*WIDTH*floor.
+        template<class OutputIt>
+        OutputIt generate_to(OutputIt out){
+            generate(RowSink([&out](int, int, const std::vector<uint8_t> &walls){
+                for(auto value : walls){
+                    *out++ = value;
+                }
+            }));
+            return out;
+        }
+
+        // Counters and phase times of the last generate() (only recorded with MAZE_INSTRUMENT, see BuildStats.h)
+        const BuildStats &stats() const { return eller.stats; }
+
+        virtual ~MazeStream();
+
+    protected:
+
+    private:
+        // Variables
+        double EAST_WALL_THRESHOLD;
+        double SOUTH_WALL_THRESHOLD;
+
+        // The row kernel (shared with FixedMaze), holding the sets of the live rooms
+        EllerRows<EllerVectors> eller;
+
+        std::vector<uint8_t> from_below;    // Live room has a passage down
+        std::vector<uint8_t> north_open;    // SOUTH passages of the row before
+        std::vector<uint8_t> row_walls;
+
+        // Methods
+        void emit_row(int, int, const RowSink&);
+};
+
+#endif // MAZESTREAM_H
@@ -0,0 +1,150 @@
+#ifndef PACKEDWALLS_H
+#define PACKEDWALLS_H
+
+#include<vector>
+#include<memory>
+#include<cstdint>
+class PackedWalls
+{
+    /* Wall storage using 3 bits per room.
+     *
+     * Only the EAST, SOUTH and CEIL walls of each room are stored (a set bit is a wall).
+     * The WEST, NORTH and FLOOR walls of a room are the EAST, SOUTH and CEIL walls of its neighbour.
+     *
+     * Rooms are stored in blocks of 64, each block being three words: EAST, SOUTH and CEIL bits.
+     * Each floor starts on a new block, so two floors never share a word.
+     *
+     * The blocks are either owned, or a read-only view of memory kept alive by an owner
+     * (such as a memory mapped file, see Maze::open).
+     */
+    public:
+        PackedWalls();
+        PackedWalls(int, int, int);
+        PackedWalls(const PackedWalls &);
+        PackedWalls(PackedWalls &&);
+        PackedWalls &operator=(const PackedWalls &);
+        PackedWalls &operator=(PackedWalls &&);
+
+        // Word of each wall in a block
+        static const int EAST_WORD  = 0;
+        static const int SOUTH_WORD = 1;
+        static const int CEIL_WORD  = 2;
+
+        // Bit of each wall of a room, as room_walls() gives them (Maze::FLOOR, Maze::EAST, ... are the same)
+        static const int FLOOR_BIT = 1;
+        static const int EAST_BIT  = 2;
+        static const int NORTH_BIT = 4;
+        static const int WEST_BIT  = 8;
+        static const int SOUTH_BIT = 16;
+        static const int CEIL_BIT  = 32;
+
+        // Resizes to length * width * height rooms, all walls up.
+        void reset(int length, int width, int height);
+
+        // Uses the blocks at data (floor_words() * height words) without copying.
+        // owner keeps the memory alive for as long as it is used.
+        void view(int length, int width, int height, const uint64_t *data, std::shared_ptr<const void> owner);
+
+        // Are the blocks a read-only view?
+        bool is_view() const { return owner != nullptr; }
+
+        int length() const { return LENGTH; }
+        int width()  const { return WIDTH; }
+        int height() const { return HEIGHT; }
+
+        // Distance between a room's index and the index of the room above (a multiple of 64)
+        std::size_t floor_stride() const { return FLOOR_STRIDE; }
+
+        // Index of the room. Neighbours are at +-1, +-length() and +-floor_stride().
+        std::size_t index(int row, int col, int floor) const {
+            return col + (std::size_t)LENGTH*row + FLOOR_STRIDE*floor;
+        }
+
+        // Is the wall (EAST_WORD, SOUTH_WORD or CEIL_WORD) of the room at index up?
+        bool wall(int word, std::size_t index) const {
+            return block_wall(blocks, word, index);
+        }
+
+        // The same, in blocks laid out as data()
+        static bool block_wall(const uint64_t *blocks, int word, uint64_t index){
+            return (blocks[(index >> 6)*3 + word] >> (index & 63)) & 1;
+        }
+
+        // The walls of the room at (row, col, floor), as bits (FLOOR_BIT, EAST_BIT, ...)
+        int room_walls(int row, int col, int floor) const {
+            return room_walls([this](int word, uint64_t i){ return wall(word, i); },
+                              index(row, col, floor), row, col, floor, LENGTH, FLOOR_STRIDE);
+        }
+
+        /* The same for blocks kept anywhere (a batch of mazes, pages of a file, a FixedMaze),
+         * with wall(word, index) reading them as wall() does. The room is at index i.
+         * A room stores its EAST, SOUTH and CEIL walls; the others are stored by the rooms
+         * WEST, NORTH and below, or are outer walls.
+         */
+        template<class Wall>
+        static int room_walls(Wall &&wall, uint64_t i, int row, int col, int floor, uint64_t length, uint64_t floor_stride){
+            int value = 0;
+
+            if (wall(EAST_WORD, i))   value |= EAST_BIT;
+            if (wall(SOUTH_WORD, i))  value |= SOUTH_BIT;
+            if (wall(CEIL_WORD, i))   value |= CEIL_BIT;
+
+            if (col   == 0 || wall(EAST_WORD,  i - 1))             value |= WEST_BIT;
+            if (row   == 0 || wall(SOUTH_WORD, i - length))        value |= NORTH_BIT;
+            if (floor == 0 || wall(CEIL_WORD,  i - floor_stride))  value |= FLOOR_BIT;
+
+            return value;
+        }
+
+        // The walls of the 64 rooms starting at index, as bits. (Rooms past the end are walls)
+        uint64_t bits(int word, std::size_t index) const {
+            std::size_t block = index >> 6;
+            int shift = index & 63;
+
+            uint64_t value = blocks[block*3 + word] >> shift;
+            if (shift != 0){
+                uint64_t next = (block + 1 < size() / 3) ? blocks[(block + 1)*3 + word] : ~uint64_t(0);
+                value |= next << (64 - shift);
+            }
+            return value;
+        }
+
+        // Removes the wall of the room at index. (Not for views)
+        void open(int word, std::size_t index){
+            words[(index >> 6)*3 + word] &= ~(uint64_t(1) << (index & 63));
+        }
+
+        // Puts the wall of the room at index back up. (Not for views)
+        void close(int word, std::size_t index){
+            words[(index >> 6)*3 + word] |= uint64_t(1) << (index & 63);
+        }
+
+        // Copies the blocks of a view into blocks of its own, so they can be changed.
+        void own();
+
+        // The raw blocks (mutable_data() is not for views). Floor f is found in the words [f * floor_words(), (f + 1) * floor_words())
+        const uint64_t *data() const { return blocks; }
+        uint64_t *mutable_data() { return words.data(); }
+        std::size_t size() const { return floor_words() * HEIGHT; }
+        std::size_t floor_words() const { return FLOOR_STRIDE / 64 * 3; }
+
+        // Checksum of count words, continuing from the checksum of the words before them.
+        static uint64_t checksum(const uint64_t *data, std::size_t count, uint64_t previous = 0xcbf29ce484222325ull);
+
+        virtual ~PackedWalls();
+
+    protected:
+
+    private:
+        // Variables
+        int LENGTH;
+        int WIDTH;
+        int HEIGHT;
+        std::size_t FLOOR_STRIDE;
+
+        std::vector<uint64_t> words;
+        const uint64_t *blocks;
+        std::shared_ptr<const void> owner;
+};
+
+#endif // PACKEDWALLS_H
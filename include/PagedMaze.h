@@ -0,0 +1,70 @@
+#ifndef PAGEDMAZE_H
+#define PAGEDMAZE_H
+
+#include<list>
+#include<mutex>
+#include<string>
+#include<fstream>
+#include<vector>
+#include<cstdint>
+#include<unordered_map>
+#include "MazeFile.h"
+class PagedMaze
+{
+    /* Reads the rooms of a maze file (see Maze::save and Maze::build_to_file) without mapping or loading it.
+     *
+     * The file is read in pages of PAGE_BLOCKS blocks (64 rooms each), kept in a cache,
+     * least recently used first out, using at most about memory_budget bytes (but always at least one page).
+     * Memory does not grow with the size of the file, so mazes larger than memory (or the address space) can be read.
+     * All queries are thread safe.
+     */
+    public:
+        explicit PagedMaze(const std::string &path, std::size_t memory_budget = 64u << 20);
+
+        static const std::size_t PAGE_BLOCKS = 1024;   // 24 KiB, 65536 rooms
+
+        int LENGTH;
+        int WIDTH;
+        int HEIGHT;
+        uint64_t SEED;
+        bool EDITED;        // As Maze::EDITED, from the header
+
+        // The walls of the room at (row, col, floor), as bits (Maze::FLOOR, Maze::EAST, ...).
+        int operator()(int row, int col, int floor);
+
+        // The checksum of the walls, from the header
+        uint64_t checksum() const { return header.checksum; }
+
+        // Reads the whole file, a page at a time (without caching it), and compares its checksum with the header.
+        bool verify();
+
+        std::size_t cached_pages();
+        std::size_t page_capacity() const { return CAPACITY; }
+
+        virtual ~PagedMaze();
+
+    protected:
+
+    private:
+        typedef std::list<std::pair<uint64_t, std::vector<uint64_t>>> PageList;
+
+        // Variables
+        std::string path;
+        MazeFileHeader header;
+        uint64_t FLOOR_STRIDE;
+        uint64_t WORDS;
+        std::size_t CAPACITY;
+
+        int fd;                 // Read with pread where there is one,
+        std::ifstream file;     // and with a stream otherwise (under the lock)
+        std::mutex lock;
+        PageList pages;     // Most recently used first
+        std::unordered_map<uint64_t, PageList::iterator> page_index;
+
+        // Methods
+        const std::vector<uint64_t> &page(uint64_t);
+        void read(uint64_t, std::size_t, uint64_t *);
+        bool wall(int, uint64_t);
+};
+
+#endif // PAGEDMAZE_H
@@ -0,0 +1,201 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include<atomic>
+#include<thread>
+#include<vector>
+#include<exception>
+#include<mutex>
+#include<condition_variable>
+
+// Number of threads to use when 0 is asked for.
+inline unsigned default_threads(unsigned threads){
+    if (threads == 0){
+        threads = std::thread::hardware_concurrency();
+    }
+    return threads == 0 ? 1 : threads;
+}
+
+/* Calls work(item, worker) for every item in [0, count), spread over up to threads threads.
+ *
+ * Items are handed out one at a time from a shared counter, so uneven items balance out.
+ * worker is in [0, threads), and no two concurrent calls get the same worker,
+ * so it can be used to index per-thread scratch space.
+ * The first exception thrown by work is rethrown once all threads are done.
+ */
+template<class Work>
+void parallel_for(std::size_t count, unsigned threads, Work work){
+    threads = default_threads(threads);
+    if (threads > count){
+        threads = count;
+    }
+    if (threads <= 1){
+        for (std::size_t item = 0; item < count; item++){
+            work(item, 0u);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_lock;
+
+    auto run = [&](unsigned worker){
+        try {
+            for (std::size_t item = next++; item < count; item = next++){
+                work(item, worker);
+            }
+        } catch (...){
+            std::lock_guard<std::mutex> lock(error_lock);
+            if (!error){
+                error = std::current_exception();
+            }
+            next = count;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned worker = 1; worker < threads; worker++){
+        pool.emplace_back(run, worker);
+    }
+    run(0);
+    for (auto &thread : pool){
+        thread.join();
+    }
+
+    if (error){
+        std::rethrow_exception(error);
+    }
+}
+
+class WorkerPool
+{
+    /* Threads kept waiting between parallel loops, for callers that run many small loops
+     * (see MazeBatch). Threads are only created when the pool grows, so once it has grown,
+     * a loop neither creates threads nor allocates memory.
+     *
+     * One loop runs at a time: parallel_for must not be called from two threads at once.
+     */
+    public:
+        WorkerPool() : generation(0), active(0), busy(0), stopping(false), call(nullptr), context(nullptr) {}
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        // As ::parallel_for, on the pool's threads. The calling thread is worker 0.
+        template<class Work>
+        void parallel_for(std::size_t count, unsigned threads, Work work){
+            threads = default_threads(threads);
+            if (threads > count){
+                threads = count;
+            }
+            if (threads <= 1){
+                for (std::size_t item = 0; item < count; item++){
+                    work(item, 0u);
+                }
+                return;
+            }
+
+            std::atomic<std::size_t> next(0);
+            std::exception_ptr error;
+            std::mutex error_lock;
+
+            auto run = [&](unsigned worker){
+                try {
+                    for (std::size_t item = next++; item < count; item = next++){
+                        work(item, worker);
+                    }
+                } catch (...){
+                    std::lock_guard<std::mutex> guard(error_lock);
+                    if (!error){
+                        error = std::current_exception();
+                    }
+                    next = count;
+                }
+            };
+            typedef decltype(run) Run;
+
+            start(threads - 1, [](void *loop, unsigned worker){ (*static_cast<Run*>(loop))(worker); }, &run);
+            run(0);
+            finish();
+
+            if (error){
+                std::rethrow_exception(error);
+            }
+        }
+
+        std::size_t threads() const { return helpers.size() + 1; }
+
+        virtual ~WorkerPool(){
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto &thread : helpers){
+                thread.join();
+            }
+        }
+
+    protected:
+
+    private:
+        // Variables
+        std::vector<std::thread> helpers;   // Helper h is worker h + 1
+        std::mutex lock;
+        std::condition_variable wake;
+        std::condition_variable done;
+        uint64_t generation;                // Loops started
+        unsigned active;                    // Helpers taking part in the current loop
+        unsigned busy;                      // Helpers still working on it
+        bool stopping;
+        void (*call)(void*, unsigned);
+        void *context;
+
+        // Methods
+        void start(unsigned helpers_needed, void (*loop_call)(void*, unsigned), void *loop){
+            // New helpers wait for the loop after the last one (only this thread changes generation)
+            while (helpers.size() < helpers_needed){
+                unsigned helper = helpers.size();
+                uint64_t seen = generation;
+                helpers.emplace_back([this, helper, seen]{ serve(helper, seen); });
+            }
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                call = loop_call;
+                context = loop;
+                active = helpers_needed;
+                busy = helpers_needed;
+                generation++;
+            }
+            wake.notify_all();
+        }
+
+        void finish(){
+            std::unique_lock<std::mutex> guard(lock);
+            done.wait(guard, [this]{ return busy == 0; });
+        }
+
+        void serve(unsigned helper, uint64_t seen){
+            std::unique_lock<std::mutex> guard(lock);
+            while (true){
+                wake.wait(guard, [&]{ return stopping || generation != seen; });
+                if (stopping){
+                    return;
+                }
+                seen = generation;
+                if (helper >= active){
+                    continue;
+                }
+
+                guard.unlock();
+                call(context, helper + 1);
+                guard.lock();
+
+                if (--busy == 0){
+                    done.notify_one();
+                }
+            }
+        }
+};
+
+#endif // PARALLELFOR_H
@@ -0,0 +1,76 @@
+#ifndef TILEDMAZE_H
+#define TILEDMAZE_H
+
+#include<list>
+#include<mutex>
+#include<vector>
+#include<cstdint>
+#include<unordered_map>
+#include "Maze.h"
+class TiledMaze
+{
+    /* A maze without end (EAST, SOUTH and UP), built one tile at a time when it is looked at.
+     *
+     * The maze is split into tiles of tile_columns * tile_rows * tile_floors rooms.
+     * Each tile is a perfect Maze of its own, built from a seed drawn from (seed, tile).
+     * Every tile but the first links to exactly one neighbouring tile WEST, NORTH or below it,
+     * through a single door. The tiles form a tree, so the whole maze is perfect,
+     * and the doors of a tile only depend on (seed, tile), so neighbouring tiles always agree.
+     *
+     * Built tiles are kept in a cache, least recently used first out,
+     * using at most about memory_budget bytes (but always at least one tile).
+     * All queries are thread safe.
+     */
+    public:
+        TiledMaze(int, int, int, double, double, uint64_t seed, std::size_t memory_budget = 64u << 20);
+
+        int TILE_LENGTH;
+        int TILE_WIDTH;
+        int TILE_HEIGHT;
+        uint64_t SEED;
+
+        // The walls of the room, as bits (Maze::FLOOR, Maze::EAST, ...). Coordinates can not be negative.
+        int operator()(int64_t row, int64_t col, int64_t floor);
+
+        // The walls of a box of rooms, starting at (row, col, floor),
+        // stored at walls[c + columns*r + columns*rows*f].
+        void region(int64_t row, int64_t col, int64_t floor, int rows, int columns, int floors, std::vector<uint8_t> &walls);
+
+        std::size_t cached_tiles();
+        std::size_t tile_capacity() const { return CAPACITY; }
+
+        virtual ~TiledMaze();
+
+    protected:
+
+    private:
+        struct TileKey {
+            int64_t row, col, floor;
+            bool operator==(const TileKey &other) const {
+                return row == other.row && col == other.col && floor == other.floor;
+            }
+        };
+        struct TileHash {
+            std::size_t operator()(const TileKey &key) const;
+        };
+        typedef std::list<std::pair<TileKey, Maze>> TileList;
+
+        // Variables
+        double EAST_WALL_THRESHOLD;
+        double SOUTH_WALL_THRESHOLD;
+        std::size_t CAPACITY;
+        MazeRandom random;
+
+        std::mutex lock;
+        TileList tiles;     // Most recently used first
+        std::unordered_map<TileKey, TileList::iterator, TileHash> tile_index;
+
+        // Methods
+        const Maze &tile(const TileKey &);
+        int room(int64_t, int64_t, int64_t, const Maze *&, TileKey &);
+        static uint64_t tile_number(const TileKey &);
+        int link(const TileKey &) const;
+        bool door(const TileKey &, int, int, int) const;
+};
+
+#endif // TILEDMAZE_H
@@ -0,0 +1,64 @@
+/*****************************************************************************************
+ **                     BUILD STATS                                                     **
+ **         Counters and phase times of maze builds (with MAZE_INSTRUMENT).             **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "BuildStats.h"
+#include <algorithm>
+
+#ifdef MAZE_INSTRUMENT
+const bool BuildStats::ENABLED = true;
+#else
+const bool BuildStats::ENABLED = false;
+#endif
+
+void BuildStats::clear(){
+    total = reset = draw = east = south = pick = emit = advance = compact = 0;
+    rows = finds = set_merges = sets_created = compactions = sets_dropped = 0;
+    passages_east = passages_south = passages_up = 0;
+    peak_sets = peak_row_sets = 0;
+}
+
+void BuildStats::add(const BuildStats &other){
+    total   += other.total;
+    reset   += other.reset;
+    draw    += other.draw;
+    east    += other.east;
+    south   += other.south;
+    pick    += other.pick;
+    emit    += other.emit;
+    advance += other.advance;
+    compact += other.compact;
+
+    rows           += other.rows;
+    finds          += other.finds;
+    set_merges     += other.set_merges;
+    sets_created   += other.sets_created;
+    compactions    += other.compactions;
+    sets_dropped   += other.sets_dropped;
+    passages_east  += other.passages_east;
+    passages_south += other.passages_south;
+    passages_up    += other.passages_up;
+
+    peak_sets     = std::max(peak_sets, other.peak_sets);
+    peak_row_sets = std::max(peak_row_sets, other.peak_row_sets);
+}
+
+void BuildStats::write_json(std::ostream &out) const {
+    out << "{\"instrumented\": " << (ENABLED ? "true" : "false")
+        << ", \"seconds\": {\"total\": " << total << ", \"reset\": " << reset << ", \"draw\": " << draw
+        << ", \"east\": " << east << ", \"south\": " << south << ", \"pick\": " << pick
+        << ", \"emit\": " << emit << ", \"advance\": " << advance << ", \"compact\": " << compact << "}"
+        << ", \"rows\": " << rows
+        << ", \"finds\": " << finds
+        << ", \"set_merges\": " << set_merges
+        << ", \"sets_created\": " << sets_created
+        << ", \"compactions\": " << compactions
+        << ", \"sets_dropped\": " << sets_dropped
+        << ", \"passages_east\": " << passages_east
+        << ", \"passages_south\": " << passages_south
+        << ", \"passages_up\": " << passages_up
+        << ", \"peak_sets\": " << peak_sets
+        << ", \"peak_row_sets\": " << peak_row_sets << "}";
+}
@@ -0,0 +1,30 @@
+/*****************************************************************************************
+ **                     DISJOINT SET                                                    **
+ **         Keeps track of which rooms are connected during maze generation.           **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "DisjointSet.h"
+
+DisjointSet::DisjointSet()
+{
+    // An empty disjoint set. Elements are added with add().
+}
+
+DisjointSet::DisjointSet(std::size_t capacity)
+{
+    reset(capacity);
+}
+
+void DisjointSet::reset(std::size_t capacity){
+    // Removes all elements. Adding up to capacity elements will not reallocate.
+    parent.clear();
+    rank.clear();
+    parent.reserve(capacity);
+    rank.reserve(capacity);
+}
+
+DisjointSet::~DisjointSet()
+{
+    // Containers clean up after themselves
+}
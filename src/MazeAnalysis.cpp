@@ -0,0 +1,180 @@
+/*****************************************************************************************
+ **                     3D MAZE - ANALYSIS                                              **
+ **         Checks that a maze is perfect, and counts its dead ends, junctions,         **
+ **         stairs and longest path.                                                    **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeAnalysis.h"
+#include "MazeSolver.h"
+#include "Bits.h"
+#include <algorithm>
+
+MazeAnalysis::MazeAnalysis(const Maze &maze)
+{
+    /* The MazeAnalysis class constructor
+     *       Input:
+     *           const Maze &maze - The maze to check. (Built or opened)
+     *
+     *       Output:
+     *           MazeAnalysis object, holding the results.
+     *
+     * A maze with open outer walls is not searched (the searches would step out of it):
+     * it is reported as not connected, with components 0.
+     */
+    const PackedWalls &walls = maze.packed();
+
+    rooms = (uint64_t)maze.LENGTH * maze.WIDTH * maze.HEIGHT;
+    std::fill(degree, degree + 7, 0);
+    std::fill(diameter_from, diameter_from + 3, 0);
+    std::fill(diameter_to, diameter_to + 3, 0);
+    diameter = 0;
+
+    count_outer_openings(walls);
+    sweep(walls);
+
+    dead_ends = degree[1];
+    junctions = degree[3] + degree[4] + degree[5] + degree[6];
+
+    if (outer_openings != 0){
+        components = 0;
+        connected = false;
+        acyclic = false;
+        return;
+    }
+
+    // The farthest room from any room is an end of the longest path (in a tree),
+    // and a search from it finds the other end.
+    MazeSolver solver(maze);
+    MazeSolver::Farthest end = solver.farthest(0, 0, 0);
+
+    connected = end.reached == rooms;
+    components = connected ? 1 : solver.components();
+
+    // A forest of components trees has rooms - components passages; every passage more closes a loop.
+    acyclic = passages == rooms - components;
+
+    MazeSolver::Farthest other = solver.farthest(end.row, end.col, end.floor);
+    diameter = other.distance;
+    diameter_from[0] = end.row;    diameter_from[1] = end.col;    diameter_from[2] = end.floor;
+    diameter_to[0]   = other.row;  diameter_to[1]   = other.col;  diameter_to[2]   = other.floor;
+}
+
+void MazeAnalysis::count_outer_openings(const PackedWalls &walls){
+    // The EAST walls of the last column, SOUTH walls of the last row and CEIL walls of the top floor.
+    int length = walls.length(), width = walls.width(), height = walls.height();
+    outer_openings = 0;
+
+    for (int floor = 0; floor < height; floor++){
+        for (int row = 0; row < width; row++){
+            outer_openings += !walls.wall(PackedWalls::EAST_WORD, walls.index(row, length - 1, floor));
+        }
+        for (int col = 0; col < length; col++){
+            outer_openings += !walls.wall(PackedWalls::SOUTH_WORD, walls.index(width - 1, col, floor));
+        }
+    }
+    for (int row = 0; row < width; row++){
+        for (int col = 0; col < length; col++){
+            outer_openings += !walls.wall(PackedWalls::CEIL_WORD, walls.index(row, col, height - 1));
+        }
+    }
+}
+
+void MazeAnalysis::sweep(const PackedWalls &walls){
+    /* Counts the passages out of 64 rooms at a time.
+     *
+     * Each block gives the open EAST, SOUTH and CEIL walls of its rooms; the open WEST, NORTH and FLOOR
+     * walls are the same bits of the rooms 1, length and floor_stride before, shifted into place.
+     * The six masks are added bit by bit into a 3 bit count per room, and the rooms of each count
+     * are counted with one popcount.
+     */
+    const uint64_t *data = walls.data();
+    const uint64_t ALL = ~uint64_t(0);
+    std::size_t length = walls.length();
+    std::size_t stride = walls.floor_stride();
+    std::size_t floor_rooms = length * walls.width();
+    std::size_t floor_blocks = stride / 64;
+
+    passages = 0;
+    stairs = 0;
+
+    for (int floor = 0; floor < walls.height(); floor++){
+        for (std::size_t k = 0; k < floor_blocks; k++){
+            std::size_t b = floor * floor_blocks + k;
+            std::size_t first = b * 64;
+
+            // Rooms of this floor in the block (the rest is padding)
+            std::size_t in_floor = floor_rooms - std::min(floor_rooms, k * 64);
+            if (in_floor == 0) break;
+            uint64_t valid = in_floor >= 64 ? ALL : (uint64_t(1) << in_floor) - 1;
+
+            uint64_t east_walls  = data[b*3 + PackedWalls::EAST_WORD];
+            uint64_t south_walls = data[b*3 + PackedWalls::SOUTH_WORD];
+            uint64_t ceil_walls  = data[b*3 + PackedWalls::CEIL_WORD];
+
+            uint64_t west_walls = (east_walls << 1) | (b > 0 ? data[(b - 1)*3 + PackedWalls::EAST_WORD] >> 63 : 1);
+            if (k == 0) west_walls |= 1;      // First column of the floor
+
+            uint64_t north_walls;
+            if (first >= length + floor * stride){
+                north_walls = walls.bits(PackedWalls::SOUTH_WORD, first - length);
+            }
+            else {
+                // The first row of the floor has no rooms to the north
+                std::size_t shift = length + floor * stride - first;
+                north_walls = shift >= 64 ? ALL : (walls.bits(PackedWalls::SOUTH_WORD, first + shift - length) << shift) | ((uint64_t(1) << shift) - 1);
+            }
+
+            uint64_t floor_walls = floor > 0 ? data[(b - floor_blocks)*3 + PackedWalls::CEIL_WORD] : ALL;
+
+            uint64_t open[6] = {~east_walls, ~west_walls, ~south_walls, ~north_walls, ~ceil_walls, ~floor_walls};
+
+            // Bit sliced count of the open walls of each room
+            uint64_t c0 = 0, c1 = 0, c2 = 0;
+            for (uint64_t x : open){
+                x &= valid;
+                uint64_t carry = c0 & x;
+                c0 ^= x;
+                uint64_t carry2 = c1 & carry;
+                c1 ^= carry;
+                c2 |= carry2;
+            }
+            for (int d = 0; d < 7; d++){
+                uint64_t rooms_of = valid & (d & 1 ? c0 : ~c0) & (d & 2 ? c1 : ~c1) & (d & 4 ? c2 : ~c2);
+                degree[d] += count_bits(rooms_of);
+            }
+
+            stairs   += count_bits(~ceil_walls & valid);
+            passages += count_bits(~east_walls & valid) + count_bits(~south_walls & valid);
+        }
+    }
+
+    // Open outer walls lead out of the maze, not between rooms
+    passages += stairs;
+    passages -= std::min(passages, outer_openings);
+}
+
+void MazeAnalysis::write_json(std::ostream &out) const {
+    out << "{\"rooms\": " << rooms
+        << ", \"perfect\": " << (perfect() ? "true" : "false")
+        << ", \"connected\": " << (connected ? "true" : "false")
+        << ", \"acyclic\": " << (acyclic ? "true" : "false")
+        << ", \"components\": " << components
+        << ", \"outer_openings\": " << outer_openings
+        << ", \"passages\": " << passages
+        << ", \"stairs\": " << stairs
+        << ", \"dead_ends\": " << dead_ends
+        << ", \"junctions\": " << junctions
+        << ", \"degree\": [";
+    for (int d = 0; d < 7; d++){
+        out << (d ? ", " : "") << degree[d];
+    }
+    out << "], \"diameter\": " << diameter
+        << ", \"diameter_from\": [" << diameter_from[0] << ", " << diameter_from[1] << ", " << diameter_from[2] << "]"
+        << ", \"diameter_to\": [" << diameter_to[0] << ", " << diameter_to[1] << ", " << diameter_to[2] << "]}";
+}
+
+MazeAnalysis::~MazeAnalysis()
+{
+    // Containers clean up after themselves
+}
@@ -0,0 +1,87 @@
+/*****************************************************************************************
+ **                     3D MAZE - BATCHES                                               **
+ **         Generates many small mazes of one shape into a single block of memory.      **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeBatch.h"
+#include <algorithm>
+#include <stdexcept>
+
+MazeBatch::MazeBatch(int columns, int rows, int floors, double horizontal_bias, double vertical_bias)
+{
+    /* The MazeBatch class constructor
+     *       Input: Same as the Maze constructor, without the seed. (Each maze gets its seed in generate())
+     *
+     *       Output:
+     *           MazeBatch object, without mazes.
+     */
+    if (rows < 1 || columns < 1 || floors < 1){
+        throw std::invalid_argument("A maze must have dimensions greater than zero.\n");
+    }
+    if (horizontal_bias <= 0 || horizontal_bias >= 1 || vertical_bias <= 0 || vertical_bias >= 1){
+        throw std::invalid_argument("Biases must be between 0 and 1 exclusive.\n");
+    }
+    LENGTH = columns;
+    WIDTH  = rows;
+    HEIGHT = floors;
+    EAST_WALL_THRESHOLD  = horizontal_bias;
+    SOUTH_WALL_THRESHOLD = vertical_bias;
+
+    // Same layout as PackedWalls
+    FLOOR_STRIDE = ((std::size_t)LENGTH*WIDTH + 63) & ~(std::size_t)63;
+    MAZE_WORDS   = FLOOR_STRIDE / 64 * 3 * HEIGHT;
+}
+
+void MazeBatch::generate(const uint64_t *seeds, std::size_t count, unsigned threads){
+    /* Each thread takes the next maze, points its stream's sink at the maze's place
+     * in the arena, and opens the walls there as the rows come out.
+     */
+    threads = default_threads(threads);
+    threads = std::max<unsigned>(1, std::min<std::size_t>(threads, count));
+
+    SEEDS.assign(seeds, seeds + count);
+    arena.assign(count * MAZE_WORDS, ~uint64_t(0));
+
+    // One stream and one sink per thread, kept for later calls.
+    // Each sink writes to wherever its thread's target points.
+    while (streams.size() < threads){
+        unsigned worker = streams.size();
+        streams.emplace_back(LENGTH, WIDTH, HEIGHT, EAST_WALL_THRESHOLD, SOUTH_WALL_THRESHOLD, 0);
+
+        sinks.emplace_back([this, worker](int row, int floor, const std::vector<uint8_t> &walls){
+            uint64_t *blocks = targets[worker];
+            std::size_t i = (std::size_t)LENGTH*row + FLOOR_STRIDE*floor;
+
+            for (int col = 0; col < LENGTH; col++, i++){
+                uint64_t bit = uint64_t(1) << (i & 63);
+                uint64_t *block = blocks + (i >> 6)*3;
+
+                if (!(walls[col] & Maze::EAST))   block[PackedWalls::EAST_WORD]  &= ~bit;
+                if (!(walls[col] & Maze::SOUTH))  block[PackedWalls::SOUTH_WORD] &= ~bit;
+                if (!(walls[col] & Maze::CEIL))   block[PackedWalls::CEIL_WORD]  &= ~bit;
+            }
+        });
+    }
+    targets.resize(streams.size());
+
+    pool.parallel_for(count, threads, [&](std::size_t maze, unsigned worker){
+        targets[worker] = arena.data() + maze * MAZE_WORDS;
+        streams[worker].reseed(SEEDS[maze]);
+        streams[worker].generate(sinks[worker]);
+    });
+}
+
+int MazeBatch::operator()(std::size_t maze, int row, int col, int floor) const {
+    if (maze >= size() || row < 0 || row >= WIDTH || col < 0 || col >= LENGTH || floor < 0 || floor >= HEIGHT){
+        throw std::out_of_range("Room is outside the maze.\n");
+    }
+    const uint64_t *blocks = data(maze);
+    return PackedWalls::room_walls([blocks](int word, uint64_t i){ return PackedWalls::block_wall(blocks, word, i); },
+                                   col + (std::size_t)LENGTH*row + FLOOR_STRIDE*floor, row, col, floor, LENGTH, FLOOR_STRIDE);
+}
+
+MazeBatch::~MazeBatch()
+{
+    // Containers clean up after themselves
+}
@@ -0,0 +1,287 @@
+/*****************************************************************************************
+ **                     3D MAZE - FILES                                                 **
+ **         Saves a maze in a binary file, and opens it again without copying,          **
+ **         by memory mapping the file.                                                 **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "Maze.h"
+#include "MazeFile.h"
+#include "MazePipeline.h"
+#include "Bits.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define MAZE_USE_MMAP 1
+#endif
+
+namespace {
+    const char MAGIC[8] = {'M', 'A', 'Z', 'E', '3', 'D', 0, 0};
+
+    // Maze files hold the header and the blocks as they are in memory, which is little endian only on little endian machines.
+    // (The blocks are read straight from the mapping, so they can not be swapped on the way)
+    void require_little_endian(){
+        if (!little_endian()){
+            throw std::runtime_error("Maze files can only be read and written on little endian machines.\n");
+        }
+    }
+
+    bool valid_bias(double bias){
+        return bias > 0 && bias < 1;    // False for NaN
+    }
+
+    /* Maze files are written next to their path, and moved over it once complete.
+     * A maze opened from the old file (mapped, see Maze::open) keeps reading the old file,
+     * which truncating it in place would pull out from under the mapping.
+     */
+    std::string partial_path(const std::string &path){
+        return path + ".partial";
+    }
+
+    void replace_file(std::ofstream &file, const std::string &path){
+        std::string partial = partial_path(path);
+        file.close();
+        if (file.fail()){
+            std::remove(partial.c_str());
+            throw std::runtime_error("Could not write " + path + ".\n");
+        }
+        // Windows does not rename over an existing file
+        if (std::rename(partial.c_str(), path.c_str()) != 0
+            && (std::remove(path.c_str()) != 0 || std::rename(partial.c_str(), path.c_str()) != 0)){
+            std::remove(partial.c_str());
+            throw std::runtime_error("Could not replace " + path + ".\n");
+        }
+    }
+}
+
+MazeFileHeader MazeFileHeader::make(int length, int width, int height, uint64_t seed,
+                                    double horizontal_bias, double vertical_bias, uint64_t checksum, uint32_t flags){
+    require_little_endian();
+
+    MazeFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+
+    header.version = VERSION;
+    header.layout  = LAYOUT;
+    header.length  = length;
+    header.width   = width;
+    header.height  = height;
+    header.seed    = seed;
+    header.horizontal_bias = horizontal_bias;
+    header.vertical_bias   = vertical_bias;
+    header.checksum = checksum;
+    header.flags    = flags;
+    return header;
+}
+
+uint64_t MazeFileHeader::data_words() const {
+    // Same as PackedWalls::size()
+    uint64_t floor_stride = ((uint64_t)length * width + 63) & ~(uint64_t)63;
+    return floor_stride / 64 * 3 * height;
+}
+
+void MazeFileHeader::check(uint64_t file_size, const std::string &path) const {
+    require_little_endian();
+
+    if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0){
+        throw std::runtime_error(path + " is not a maze file.\n");
+    }
+    if (version != VERSION || layout != LAYOUT || (flags & ~EDITED)){
+        throw std::runtime_error(path + " is a maze file of an unknown version.\n");
+    }
+    if (length < 1 || width < 1 || height < 1){
+        throw std::runtime_error(path + " is a maze file with invalid dimensions.\n");
+    }
+    if (!valid_bias(horizontal_bias) || !valid_bias(vertical_bias)){
+        throw std::runtime_error(path + " is a maze file with invalid biases.\n");
+    }
+    if (file_size != sizeof(MazeFileHeader) + data_words() * sizeof(uint64_t)){
+        throw std::runtime_error(path + " is a maze file of the wrong size.\n");
+    }
+}
+
+Maze::Maze()
+{
+    // An empty maze, to be filled in by Maze::open
+    LENGTH = WIDTH = HEIGHT = 0;
+    SEED = 0;
+    EDITED = false;
+    EAST_WALL_THRESHOLD = SOUTH_WALL_THRESHOLD = 0;
+}
+
+Maze Maze::view(int columns, int rows, int floors, double horizontal_bias, double vertical_bias, uint64_t seed,
+                const uint64_t *blocks, std::shared_ptr<const void> owner){
+    // As Maze::open, with the blocks and the header given.
+    if (rows < 1 || columns < 1 || floors < 1){
+        throw std::invalid_argument("A maze must have dimensions greater than zero.\n");
+    }
+    if (!valid_bias(horizontal_bias) || !valid_bias(vertical_bias)){
+        throw std::invalid_argument("Biases must be between 0 and 1 exclusive.\n");
+    }
+    Maze maze;
+    maze.LENGTH = columns;
+    maze.WIDTH  = rows;
+    maze.HEIGHT = floors;
+    maze.SEED   = seed;
+    maze.EDITED = false;
+    maze.EAST_WALL_THRESHOLD  = horizontal_bias;
+    maze.SOUTH_WALL_THRESHOLD = vertical_bias;
+    maze.wall_data.view(columns, rows, floors, blocks, std::move(owner));
+    return maze;
+}
+
+void Maze::save(const std::string &path) const {
+    /* Saves the maze as a binary file: A MazeFileHeader followed by the wall blocks, as in memory.
+     * The file is replaced once written, so a maze can be saved over the file it was opened from.
+     * Throws std::runtime_error if the file can not be written.
+     */
+    std::ofstream file(partial_path(path), std::ios::binary | std::ios::trunc);
+    if (!file){
+        throw std::runtime_error("Could not create " + path + ".\n");
+    }
+
+    const uint64_t *blocks = wall_data.data();
+    std::size_t words = wall_data.size();
+
+    MazeFileHeader header = MazeFileHeader::make(LENGTH, WIDTH, HEIGHT, SEED,
+                                                 EAST_WALL_THRESHOLD, SOUTH_WALL_THRESHOLD,
+                                                 PackedWalls::checksum(blocks, words),
+                                                 EDITED ? MazeFileHeader::EDITED : 0);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(blocks), words * sizeof(uint64_t));
+    replace_file(file, path);
+}
+
+uint64_t Maze::build_to_file(const std::string &path, int columns, int rows, int floors,
+                             double horizontal_bias, double vertical_bias, uint64_t seed){
+    /* Builds a maze into a maze file (as Maze::save writes it), without keeping the maze in memory.
+     *
+     * MazePipeline generates the floors on a thread of its own, while the finished floors
+     * are written out (and added to the checksum) here.
+     * The header goes in last, when the checksum is known, and the file replaces path once complete (as in save()).
+     *
+     *      Throws std::invalid_argument for invalid dimensions or biases (as the Maze constructor),
+     *      and std::runtime_error if the file can not be written.
+     */
+    MazePipeline pipeline(columns, rows, floors, horizontal_bias, vertical_bias, seed);
+
+    std::ofstream file(partial_path(path), std::ios::binary | std::ios::trunc);
+    if (!file){
+        throw std::runtime_error("Could not create " + path + ".\n");
+    }
+
+    MazeFileHeader header = MazeFileHeader::make(columns, rows, floors, seed, horizontal_bias, vertical_bias, 0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t checksum = PackedWalls::checksum(nullptr, 0);
+    MazePipeline::Floor floor;
+
+    try {
+        while (pipeline.next(floor)){
+            checksum = PackedWalls::checksum(floor.walls.data(), floor.walls.size(), checksum);
+            if (!file.write(reinterpret_cast<const char*>(floor.walls.data()), floor.walls.size() * sizeof(uint64_t))){
+                throw std::runtime_error("Could not write " + path + " (floor " + std::to_string(floor.number) + ").\n");
+            }
+        }
+    } catch (...){
+        file.close();
+        std::remove(partial_path(path).c_str());
+        throw;
+    }
+
+    header.checksum = checksum;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    replace_file(file, path);
+    return checksum;
+}
+
+Maze Maze::open(const std::string &path, bool verify){
+    /* Opens a maze saved by Maze::save.
+     *
+     * The file is memory mapped (read only), and the walls are read straight from the mapping,
+     * so opening is instant and processes opening the same file share its pages.
+     * Building the maze again replaces the mapping with walls of its own.
+     *
+     *      Input:
+     *          path   - The maze file.
+     *          verify - Compare the checksum of the walls with the header.
+     *                   (Reads the whole file)
+     *
+     *      Throws std::runtime_error if the file can not be read, or is not a valid maze file.
+     */
+    Maze maze;
+    MazeFileHeader header;
+
+#ifdef MAZE_USE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        throw std::runtime_error("Could not open " + path + ".\n");
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(header)){
+        ::close(fd);
+        throw std::runtime_error(path + " is not a maze file.\n");
+    }
+    std::size_t size = info.st_size;
+
+    void *memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED){
+        throw std::runtime_error("Could not map " + path + ".\n");
+    }
+    std::shared_ptr<const void> mapping(memory, [size](const void *address){
+        munmap(const_cast<void*>(address), size);
+    });
+
+    std::memcpy(&header, memory, sizeof(header));
+    header.check(size, path);
+
+    const uint64_t *blocks = reinterpret_cast<const uint64_t*>(static_cast<const char*>(memory) + sizeof(header));
+#else
+    // No memory mapping available: Read the file into memory instead.
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file){
+        throw std::runtime_error("Could not open " + path + ".\n");
+    }
+    uint64_t size = file.tellg();
+    file.seekg(0);
+    if (size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))){
+        throw std::runtime_error(path + " is not a maze file.\n");
+    }
+    header.check(size, path);
+
+    auto memory = std::make_shared<std::vector<uint64_t>>(header.data_words());
+    if (!file.read(reinterpret_cast<char*>(memory->data()), memory->size() * sizeof(uint64_t))){
+        throw std::runtime_error("Could not read " + path + ".\n");
+    }
+    const uint64_t *blocks = memory->data();
+    std::shared_ptr<const void> mapping = memory;
+#endif
+
+    if (verify && PackedWalls::checksum(blocks, header.data_words()) != header.checksum){
+        throw std::runtime_error(path + " is corrupt (checksum mismatch).\n");
+    }
+
+    maze.LENGTH = header.length;
+    maze.WIDTH  = header.width;
+    maze.HEIGHT = header.height;
+    maze.SEED   = header.seed;
+    maze.EDITED = header.flags & MazeFileHeader::EDITED;
+    maze.EAST_WALL_THRESHOLD  = header.horizontal_bias;
+    maze.SOUTH_WALL_THRESHOLD = header.vertical_bias;
+    maze.wall_data.view(header.length, header.width, header.height, blocks, mapping);
+
+    return maze;
+}
@@ -0,0 +1,369 @@
+/*****************************************************************************************
+ **                     3D MAZE - GENERATORS                                            **
+ **         Other ways of carving a perfect maze: Kruskal's and Wilson's algorithms,    **
+ **         and the growing tree. (And the modified Eller's algorithm of build())       **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeGenerator.h"
+#include "MazeStream.h"
+#include "MazeRandom.h"
+#include "DisjointSet.h"
+#include "Maze.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // Moves between rooms, as used by the walks
+    const int EAST_MOVE  = 0;
+    const int WEST_MOVE  = 1;
+    const int SOUTH_MOVE = 2;
+    const int NORTH_MOVE = 3;
+    const int UP_MOVE    = 4;
+    const int DOWN_MOVE  = 5;
+
+    // A number below n (n at most 2^32), from a draw
+    inline std::size_t below(uint32_t draw, std::size_t n){
+        return ((uint64_t)draw * n) >> 32;
+    }
+
+    class Grid
+    {
+        /* The rooms of a PackedWalls, by index: the moves out of each room, and the passages between them.
+         */
+        public:
+            explicit Grid(PackedWalls &w)
+                : walls(w), LENGTH(w.length()), WIDTH(w.width()), HEIGHT(w.height()), STRIDE(w.floor_stride())
+            {
+                STEPS[EAST_MOVE]  = 1;
+                STEPS[WEST_MOVE]  = -1;
+                STEPS[SOUTH_MOVE] = LENGTH;
+                STEPS[NORTH_MOVE] = -(std::ptrdiff_t)LENGTH;
+                STEPS[UP_MOVE]    = STRIDE;
+                STEPS[DOWN_MOVE]  = -(std::ptrdiff_t)STRIDE;
+            }
+
+            // The moves that stay inside the maze, from the room at (row, col, floor). Returns how many.
+            int moves(int row, int col, int floor, int *out) const {
+                int count = 0;
+                if (col < LENGTH - 1)   out[count++] = EAST_MOVE;
+                if (col > 0)            out[count++] = WEST_MOVE;
+                if (row < WIDTH - 1)    out[count++] = SOUTH_MOVE;
+                if (row > 0)            out[count++] = NORTH_MOVE;
+                if (floor < HEIGHT - 1) out[count++] = UP_MOVE;
+                if (floor > 0)          out[count++] = DOWN_MOVE;
+                return count;
+            }
+
+            std::size_t step(std::size_t i, int move) const { return i + STEPS[move]; }
+
+            static void step(int move, int &row, int &col, int &floor){
+                switch (move){
+                    case EAST_MOVE:  col++;   break;
+                    case WEST_MOVE:  col--;   break;
+                    case SOUTH_MOVE: row++;   break;
+                    case NORTH_MOVE: row--;   break;
+                    case UP_MOVE:    floor++; break;
+                    default:         floor--; break;
+                }
+            }
+
+            void coordinates(std::size_t i, int &row, int &col, int &floor) const {
+                floor = i / STRIDE;
+                std::size_t rest = i - (std::size_t)floor * STRIDE;
+                row = rest / LENGTH;
+                col = rest - (std::size_t)row * LENGTH;
+            }
+
+            // Removes the wall between the room at index i and the room the move leads to
+            void open(std::size_t i, int move){
+                switch (move){
+                    case EAST_MOVE:  walls.open(PackedWalls::EAST_WORD,  i);          break;
+                    case WEST_MOVE:  walls.open(PackedWalls::EAST_WORD,  i - 1);      break;
+                    case SOUTH_MOVE: walls.open(PackedWalls::SOUTH_WORD, i);          break;
+                    case NORTH_MOVE: walls.open(PackedWalls::SOUTH_WORD, i - LENGTH); break;
+                    case UP_MOVE:    walls.open(PackedWalls::CEIL_WORD,  i);          break;
+                    default:         walls.open(PackedWalls::CEIL_WORD,  i - STRIDE); break;
+                }
+            }
+
+            // Bit set over the indexes of the rooms, all clear
+            std::vector<uint64_t> bits() const {
+                return std::vector<uint64_t>((STRIDE * HEIGHT + 63) / 64, 0);
+            }
+
+        private:
+            PackedWalls &walls;
+            int LENGTH;
+            int WIDTH;
+            int HEIGHT;
+            std::size_t STRIDE;
+            std::ptrdiff_t STEPS[6];
+    };
+
+    inline bool is_set(const std::vector<uint64_t> &bits, std::size_t i){ return (bits[i >> 6] >> (i & 63)) & 1; }
+    inline void set(std::vector<uint64_t> &bits, std::size_t i){ bits[i >> 6] |= uint64_t(1) << (i & 63); }
+}
+
+void MazeGenerator::carve_with_stats(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed, BuildStats &stats) const {
+    stats.clear();
+    carve(walls, horizontal_bias, vertical_bias, seed);
+}
+
+MazeGenerator::~MazeGenerator()
+{
+    // Nothing to clean up
+}
+
+void EllerGenerator::carve(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed) const {
+    BuildStats stats;
+    carve_with_stats(walls, horizontal_bias, vertical_bias, seed, stats);
+}
+
+void EllerGenerator::carve_with_stats(PackedWalls &walls, double horizontal_bias, double vertical_bias, uint64_t seed, BuildStats &stats) const {
+    // The walls are decided row by row by MazeStream. Only the EASTERN, SOUTHERN walls and ceilings are stored.
+    int length = walls.length();
+    MazeStream stream(length, walls.width(), walls.height(), horizontal_bias, vertical_bias, seed);
+
+    stream.generate([&walls, length](int row, int floor, const std::vector<uint8_t> &room_walls){
+        std::size_t i = walls.index(row, 0, floor);
+
+        for (int col = 0; col < length; col++, i++){
+            if (!(room_walls[col] & Maze::EAST))   walls.open(PackedWalls::EAST_WORD, i);
+            if (!(room_walls[col] & Maze::SOUTH))  walls.open(PackedWalls::SOUTH_WORD, i);
+            if (!(room_walls[col] & Maze::CEIL))   walls.open(PackedWalls::CEIL_WORD, i);
+        }
+    });
+    stats = stream.stats();
+}
+
+void KruskalGenerator::carve(PackedWalls &walls, double, double, uint64_t seed) const {
+    /* Passage number d*3 + dir is the passage EAST (dir 0), SOUTH (1) or UP (2) from room d = col + LENGTH*row + LENGTH*WIDTH*floor.
+     * The passages are taken in the order of (draw, number), found in three sweeps:
+     *      1. Count the passages in each bucket (the top bits of the draw)
+     *      2. Put the passage numbers in their buckets
+     *      3. Sort each bucket by draw, and try its passages.
+     */
+    const int length = walls.length();
+    const int width  = walls.width();
+    const int height = walls.height();
+
+    uint64_t floor_rooms = (uint64_t)length * width;
+    uint64_t rooms = floor_rooms * height;
+    if (rooms * 3 > UINT32_MAX){
+        throw std::invalid_argument("KruskalGenerator can build mazes of at most 1431655765 rooms.\n");
+    }
+
+    MazeRandom random(seed);
+    uint64_t steps[3] = {1, (uint64_t)length, floor_rooms};
+
+    // About 32 passages per bucket
+    std::size_t passages = rooms * 3;
+    int bucket_bits = 1;
+    while (bucket_bits < 24 && ((std::size_t)64 << bucket_bits) <= passages){
+        bucket_bits++;
+    }
+    int shift = 32 - bucket_bits;
+
+    // Calls visit(first room, dir, count) for each row of passages, with their draws in draws
+    std::vector<uint32_t> draws(length);
+    auto each_row = [&](auto visit){
+        for (int floor = 0; floor < height; floor++){
+            for (int row = 0; row < width; row++){
+                uint64_t first = (uint64_t)length * row + floor_rooms * floor;
+                int counts[3] = {length - 1, (row < width - 1) ? length : 0, (floor < height - 1) ? length : 0};
+
+                for (int dir = 0; dir < 3; dir++){
+                    random.draws(first, MazeRandom::ORDER_DRAW + dir, counts[dir], draws.data());
+                    visit(first, dir, counts[dir]);
+                }
+            }
+        }
+    };
+
+    std::vector<uint32_t> start(((std::size_t)1 << bucket_bits) + 1, 0);
+    each_row([&](uint64_t, int, int count){
+        for (int col = 0; col < count; col++){
+            start[(draws[col] >> shift) + 1]++;
+        }
+    });
+    for (std::size_t bucket = 1; bucket < start.size(); bucket++){
+        start[bucket] += start[bucket - 1];
+    }
+
+    std::vector<uint32_t> order(start.back());
+    std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+    each_row([&](uint64_t first, int dir, int count){
+        for (int col = 0; col < count; col++){
+            order[fill[draws[col] >> shift]++] = (first + col) * 3 + dir;
+        }
+    });
+    fill.clear();
+    fill.shrink_to_fit();
+
+    DisjointSet sets(rooms);
+    for (uint64_t room = 0; room < rooms; room++){
+        sets.add();
+    }
+
+    uint64_t joined = 0;
+    std::vector<uint64_t> bucket;
+    for (std::size_t b = 0; b + 1 < start.size() && joined + 1 < rooms; b++){
+        bucket.clear();
+        for (uint32_t k = start[b]; k < start[b + 1]; k++){
+            uint32_t passage = order[k];
+            bucket.push_back((uint64_t)random(passage / 3, MazeRandom::ORDER_DRAW + passage % 3) << 32 | passage);
+        }
+        std::sort(bucket.begin(), bucket.end());
+
+        for (uint64_t key : bucket){
+            uint32_t passage = (uint32_t)key;
+            uint64_t room = passage / 3;
+            int dir = passage % 3;
+
+            if (sets.unite(room, room + steps[dir])){
+                // Index of the room in the walls (floors are padded)
+                uint64_t floor = room / floor_rooms;
+                std::size_t i = room + (walls.floor_stride() - floor_rooms) * floor;
+                walls.open(dir, i);    // EAST_WORD, SOUTH_WORD and CEIL_WORD are 0, 1 and 2
+                joined++;
+            }
+        }
+    }
+}
+
+void WilsonGenerator::carve(PackedWalls &walls, double, double, uint64_t seed) const {
+    /* The first room starts the maze. Then, from each room not in the maze (in order):
+     *      Walk randomly until the maze is reached, remembering the last move out of each room.
+     *      (A walk that crosses itself overwrites the loop, so the loop is erased)
+     *      Walk again from the start following the remembered moves, opening the walls, and adding the rooms.
+     */
+    Grid grid(walls);
+    MazeRandom random(seed);
+
+    std::vector<uint64_t> in_maze = grid.bits();
+    std::vector<uint8_t> exits(walls.floor_stride() * walls.height());
+    uint64_t steps = 0;
+    int options[6];
+
+    set(in_maze, 0);
+
+    for (int floor = 0; floor < walls.height(); floor++){
+        for (int row = 0; row < walls.width(); row++){
+            for (int col = 0; col < walls.length(); col++){
+                std::size_t start = walls.index(row, col, floor);
+                if (is_set(in_maze, start)){
+                    continue;
+                }
+
+                int r = row, c = col, f = floor;
+                std::size_t i = start;
+                while (!is_set(in_maze, i)){
+                    int count = grid.moves(r, c, f, options);
+                    int move = options[below(random(steps++, MazeRandom::WALK_DRAW), count)];
+
+                    exits[i] = move;
+                    Grid::step(move, r, c, f);
+                    i = grid.step(i, move);
+                }
+
+                for (i = start; !is_set(in_maze, i); i = grid.step(i, exits[i])){
+                    set(in_maze, i);
+                    grid.open(i, exits[i]);
+                }
+            }
+        }
+    }
+}
+
+GrowingTreeGenerator::GrowingTreeGenerator(double newest)
+{
+    /* The GrowingTreeGenerator class constructor
+     *       Input:
+     *           double newest - Likelihood of growing from the newest room rather than a random one. (0 to 1)
+     */
+    if (newest < 0 || newest > 1){
+        throw std::invalid_argument("newest must be between 0 and 1.\n");
+    }
+    NEWEST_LIMIT = (newest >= 1) ? UINT32_MAX : MazeRandom::threshold(newest);
+}
+
+void GrowingTreeGenerator::carve(PackedWalls &walls, double, double, uint64_t seed) const {
+    /* Starts from the first room. Each step takes a room from the stack (the newest, or a random one),
+     * and opens a passage to a random neighbour not yet in the maze, which goes on the stack.
+     * A room without such neighbours leaves the stack.
+     *
+     * The stack stays in the order rooms were added, so the back is always the newest room.
+     * A random room that leaves is only marked finished, and dropped once it reaches the back,
+     * or when finished rooms are half the stack (all at once, keeping the order).
+     * Random picks that land on a finished room draw again. Every step is O(1) on average.
+     * With newest = 0 the order does not matter, and the last room fills the gap instead.
+     */
+    const std::size_t FINISHED = SIZE_MAX;
+
+    Grid grid(walls);
+    MazeRandom random(seed);
+
+    std::vector<uint64_t> in_maze = grid.bits();
+    std::vector<std::size_t> stack;
+    std::size_t growing = 0;        // Rooms on the stack not yet finished
+    uint64_t steps = 0;
+    int options[6];
+
+    stack.push_back(0);
+    growing++;
+    set(in_maze, 0);
+
+    while (growing > 0){
+        while (stack.back() == FINISHED){
+            stack.pop_back();
+        }
+
+        std::size_t at = stack.size() - 1;
+        if (NEWEST_LIMIT != UINT32_MAX && random(steps, MazeRandom::WALK_DRAW + 1) >= NEWEST_LIMIT){
+            do {
+                at = below(random(steps++, MazeRandom::WALK_DRAW), stack.size());
+            } while (stack[at] == FINISHED);
+        } else {
+            steps++;
+        }
+
+        std::size_t i = stack[at];
+        int row, col, floor;
+        grid.coordinates(i, row, col, floor);
+
+        int count = 0;
+        int all = grid.moves(row, col, floor, options);
+        for (int k = 0; k < all; k++){
+            if (!is_set(in_maze, grid.step(i, options[k]))){
+                options[count++] = options[k];
+            }
+        }
+
+        if (count == 0){
+            growing--;
+            if (at == stack.size() - 1){
+                stack.pop_back();
+            } else if (NEWEST_LIMIT == 0){
+                stack[at] = stack.back();
+                stack.pop_back();
+            } else {
+                stack[at] = FINISHED;
+                if (stack.size() > 2 * growing){
+                    stack.erase(std::remove(stack.begin(), stack.end(), FINISHED), stack.end());
+                }
+            }
+            continue;
+        }
+
+        int move = options[below(random(steps++, MazeRandom::WALK_DRAW), count)];
+        std::size_t next = grid.step(i, move);
+
+        grid.open(i, move);
+        set(in_maze, next);
+        stack.push_back(next);
+        growing++;
+    }
+}
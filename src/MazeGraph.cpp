@@ -0,0 +1,256 @@
+/*****************************************************************************************
+ **                     3D MAZE - GRAPH                                                 **
+ **         Exports the passages of a maze as a compressed sparse row graph,            **
+ **         in memory or straight to a file.                                            **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeGraph.h"
+#include "ParallelFor.h"
+#include "Bits.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    const char MAGIC[8] = {'M', 'A', 'Z', 'E', 'C', 'S', 'R', 0};
+
+    /* Calls visit(room, neighbour) for each passage out of each room of the floor,
+     * rooms in order and the neighbours of each room in increasing order.
+     * Rooms and neighbours are node numbers (col + LENGTH*row + LENGTH*WIDTH*floor).
+     */
+    template<class Visit>
+    void floor_passages(const PackedWalls &walls, int floor, Visit visit){
+        const uint64_t length = walls.length();
+        const uint64_t floor_rooms = length * walls.width();
+        const std::size_t stride = walls.floor_stride();
+
+        uint64_t node = floor_rooms * floor;
+        std::size_t i = stride * floor;
+
+        for (uint64_t r = 0; r < floor_rooms; r++, node++, i++){
+            // The passages into the rooms below, NORTH and WEST are stored in those rooms
+            if (floor > 0 && !walls.wall(PackedWalls::CEIL_WORD, i - stride))     visit(node, node - floor_rooms);
+            if (r >= length && !walls.wall(PackedWalls::SOUTH_WORD, i - length))  visit(node, node - length);
+            if (r % length != 0 && !walls.wall(PackedWalls::EAST_WORD, i - 1))    visit(node, node - 1);
+            if (!walls.wall(PackedWalls::EAST_WORD, i))                           visit(node, node + 1);
+            if (!walls.wall(PackedWalls::SOUTH_WORD, i))                          visit(node, node + length);
+            if (!walls.wall(PackedWalls::CEIL_WORD, i))                           visit(node, node + floor_rooms);
+        }
+    }
+
+    // Open walls of the floor (EAST_WORD, SOUTH_WORD or CEIL_WORD), counted 64 rooms at a time
+    uint64_t open_walls(const PackedWalls &walls, int floor, int word){
+        const uint64_t *blocks = walls.data() + walls.floor_words() * floor;
+        std::size_t floor_rooms = (std::size_t)walls.length() * walls.width();
+        uint64_t count = 0;
+
+        for (std::size_t first = 0; first < floor_rooms; first += 64){
+            std::size_t rooms = floor_rooms - first;
+            uint64_t valid = rooms >= 64 ? ~uint64_t(0) : (uint64_t(1) << rooms) - 1;
+            count += count_bits(~blocks[first / 64 * 3 + word] & valid);
+        }
+        return count;
+    }
+
+    // Number of neighbours stored for the rooms of each floor: Both ends of the passages on the floor,
+    // and the ends of the stairs up and down.
+    std::vector<uint64_t> count_floors(const PackedWalls &walls, unsigned threads){
+        std::vector<uint64_t> flat(walls.height());
+        std::vector<uint64_t> stairs(walls.height());
+
+        parallel_for(walls.height(), threads, [&](std::size_t floor, unsigned){
+            flat[floor]   = 2 * (open_walls(walls, floor, PackedWalls::EAST_WORD) + open_walls(walls, floor, PackedWalls::SOUTH_WORD));
+            stairs[floor] = open_walls(walls, floor, PackedWalls::CEIL_WORD);
+        });
+
+        std::vector<uint64_t> counts(walls.height());
+        for (int floor = 0; floor < walls.height(); floor++){
+            counts[floor] = flat[floor] + stairs[floor] + (floor > 0 ? stairs[floor - 1] : 0);
+        }
+        return counts;
+    }
+
+    /* Fills the offsets of the rooms of the floor (starting at first, the offset of its first room)
+     * and their neighbours.
+     */
+    template<class Index>
+    void fill_floor(const PackedWalls &walls, int floor, uint64_t first, Index *offsets, Index *neighbours){
+        const uint64_t floor_start = (uint64_t)walls.length() * walls.width() * floor;
+        uint64_t next_room = floor_start;
+        uint64_t entry = 0;
+
+        floor_passages(walls, floor, [&](uint64_t room, uint64_t neighbour){
+            while (next_room <= room){
+                offsets[next_room++ - floor_start] = first + entry;
+            }
+            neighbours[entry++] = neighbour;
+        });
+
+        // Rooms after the last passage (only if the maze is broken)
+        const uint64_t floor_end = floor_start + (uint64_t)walls.length() * walls.width();
+        while (next_room < floor_end){
+            offsets[next_room++ - floor_start] = first + entry;
+        }
+    }
+
+    // Graph files hold the numbers as they are in memory (see MazeGraphHeader)
+    void require_little_endian(){
+        if (!little_endian()){
+            throw std::runtime_error("Graph files can only be written on little endian machines.\n");
+        }
+    }
+
+    template<class Index>
+    void check_size(uint64_t nodes, uint64_t entries){
+        uint64_t largest = std::numeric_limits<Index>::max();
+        if (nodes >= largest || entries > largest){
+            throw std::length_error("The maze is too large for graphs of " + std::to_string(sizeof(Index) * 8) + " bit numbers"
+                                    " (at most " + std::to_string(largest) + " neighbours stored, and fewer rooms).\n");
+        }
+    }
+
+    template<class Index>
+    MazeGraphHeader make_header(uint64_t nodes, uint64_t entries){
+        MazeGraphHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = MazeGraphHeader::VERSION;
+        header.index_bytes = sizeof(Index);
+        header.nodes = nodes;
+        header.entries = entries;
+        return header;
+    }
+}
+
+template<class Index>
+MazeGraph<Index>::MazeGraph(const Maze &maze, unsigned threads)
+{
+    /* The MazeGraph class constructor
+     *       Input:
+     *           const Maze &maze - The maze. (Built or opened)
+     *           unsigned threads - Number of threads to use. 0 uses one per hardware thread.
+     *
+     *       Output:
+     *           MazeGraph object
+     *
+     *       Throws std::length_error if the graph does not fit in Index numbers.
+     *
+     * Each floor is counted, then filled in, on its own. The counts give where each floor starts.
+     */
+    const PackedWalls &walls = maze.packed();
+    const uint64_t floor_rooms = (uint64_t)walls.length() * walls.width();
+    const uint64_t nodes = floor_rooms * walls.height();
+
+    std::vector<uint64_t> firsts = count_floors(walls, threads);
+    uint64_t entries = 0;
+    for (auto &count : firsts){
+        uint64_t first = entries;
+        entries += count;
+        count = first;
+    }
+    check_size<Index>(nodes, entries);
+
+    offsets.resize(nodes + 1);
+    neighbours.resize(entries);
+    offsets[nodes] = entries;
+
+    parallel_for(walls.height(), threads, [&](std::size_t floor, unsigned){
+        fill_floor<Index>(walls, floor, firsts[floor], &offsets[floor_rooms * floor], neighbours.data() + firsts[floor]);
+    });
+}
+
+template<class Index>
+void MazeGraph<Index>::save(const std::string &path) const {
+    // Throws std::runtime_error if the file can not be written (or this is a big endian machine).
+    require_little_endian();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file){
+        throw std::runtime_error("Could not create " + path + ".\n");
+    }
+    MazeGraphHeader header = make_header<Index>(nodes(), entries());
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(Index));
+    file.write(reinterpret_cast<const char*>(neighbours.data()), neighbours.size() * sizeof(Index));
+
+    if (!file.flush()){
+        throw std::runtime_error("Could not write " + path + ".\n");
+    }
+}
+
+template<class Index>
+void MazeGraph<Index>::write(const Maze &maze, const std::string &path, unsigned threads){
+    /* Writes the graph file a batch of floors at a time (one floor per thread).
+     * The floors are counted first, so the place of each floor in the file is known.
+     * Throws std::length_error if the graph does not fit in Index numbers,
+     * and std::runtime_error if the file can not be written (or this is a big endian machine).
+     */
+    require_little_endian();
+    const PackedWalls &walls = maze.packed();
+    const uint64_t floor_rooms = (uint64_t)walls.length() * walls.width();
+    const uint64_t nodes = floor_rooms * walls.height();
+
+    threads = default_threads(threads);
+
+    std::vector<uint64_t> counts = count_floors(walls, threads);
+    std::vector<uint64_t> firsts(counts.size());
+    uint64_t entries = 0;
+    for (std::size_t floor = 0; floor < counts.size(); floor++){
+        firsts[floor] = entries;
+        entries += counts[floor];
+    }
+    check_size<Index>(nodes, entries);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file){
+        throw std::runtime_error("Could not create " + path + ".\n");
+    }
+    MazeGraphHeader header = make_header<Index>(nodes, entries);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const uint64_t offsets_at    = sizeof(header);
+    const uint64_t neighbours_at = offsets_at + (nodes + 1) * sizeof(Index);
+
+    // The graph of each floor in the batch
+    std::vector<std::vector<Index>> floor_offsets(threads);
+    std::vector<std::vector<Index>> floor_neighbours(threads);
+
+    for (int batch = 0; batch < walls.height(); batch += threads){
+        int floors = std::min<int>(threads, walls.height() - batch);
+
+        parallel_for(floors, threads, [&](std::size_t item, unsigned){
+            int floor = batch + item;
+            floor_offsets[item].resize(floor_rooms);
+            floor_neighbours[item].resize(counts[floor]);
+            fill_floor<Index>(walls, floor, firsts[floor], floor_offsets[item].data(), floor_neighbours[item].data());
+        });
+
+        for (int item = 0; item < floors; item++){
+            int floor = batch + item;
+            file.seekp(offsets_at + floor_rooms * floor * sizeof(Index));
+            file.write(reinterpret_cast<const char*>(floor_offsets[item].data()), floor_rooms * sizeof(Index));
+            file.seekp(neighbours_at + firsts[floor] * sizeof(Index));
+            file.write(reinterpret_cast<const char*>(floor_neighbours[item].data()), counts[floor] * sizeof(Index));
+        }
+    }
+
+    Index last = entries;
+    file.seekp(offsets_at + nodes * sizeof(Index));
+    file.write(reinterpret_cast<const char*>(&last), sizeof(last));
+
+    if (!file.flush()){
+        throw std::runtime_error("Could not write " + path + ".\n");
+    }
+}
+
+template<class Index>
+MazeGraph<Index>::~MazeGraph()
+{
+    // Containers clean up after themselves
+}
+
+template class MazeGraph<uint32_t>;
+template class MazeGraph<uint64_t>;
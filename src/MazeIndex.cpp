@@ -0,0 +1,309 @@
+/*****************************************************************************************
+ **                     3D MAZE - INDEX                                                 **
+ **         Distances and routes between any two rooms of a perfect maze,               **
+ **         by heavy path decomposition of the maze's tree.                             **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    const char MAGIC[8] = {'M', 'A', 'Z', 'E', 'I', 'D', 'X', 0};
+    const uint32_t VERSION = 1;
+
+    /* The first 64 bytes of an index file, followed by the depth, head, order and size of each room
+     * (4 bytes each, all rooms of one before the next), and the up move of each room (1 byte).
+     * All numbers are little endian.
+     */
+    struct IndexFileHeader
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        int32_t  length;
+        int32_t  width;
+        int32_t  height;
+        uint32_t reserved2;
+        uint64_t checksum;      // Of the maze's walls
+        uint64_t rooms;         // Including the padding
+        uint64_t reserved3[2];
+    };
+    static_assert(sizeof(IndexFileHeader) == 64, "The index file header must be 64 bytes.");
+
+    uint8_t opposite(uint8_t move){
+        switch (move){
+            case Maze::EAST:  return Maze::WEST;
+            case Maze::WEST:  return Maze::EAST;
+            case Maze::NORTH: return Maze::SOUTH;
+            case Maze::SOUTH: return Maze::NORTH;
+            case Maze::CEIL:  return Maze::FLOOR;
+            default:          return Maze::CEIL;
+        }
+    }
+}
+
+MazeIndex::MazeIndex(const Maze &m)
+    : MazeIndex(m, true)
+{
+    /* The MazeIndex class constructor
+     *       Input:
+     *           const Maze &m - A perfect maze. (Built or opened)
+     *
+     *       Output:
+     *           MazeIndex object, ready for queries.
+     *
+     *       Throws std::invalid_argument if the maze has a loop, an open outer wall, or rooms that can not be reached,
+     *       and std::length_error for mazes of more than 4294967295 rooms.
+     */
+}
+
+MazeIndex::MazeIndex(const Maze &m, bool make)
+    : maze(m), walls(m.packed())
+{
+    LENGTH = walls.length();
+    STRIDE = walls.floor_stride();
+    ROOMS  = STRIDE * walls.height();
+
+    if (ROOMS > UINT32_MAX){
+        throw std::length_error("MazeIndex can index mazes of at most 4294967295 rooms.\n");
+    }
+    if (make){
+        build();
+    }
+}
+
+void MazeIndex::build(){
+    /*  1. Breadth first from the first room: the depth and the move up of each room,
+     *     checking that the maze is a tree reaching every room.
+     *  2. In reverse breadth first order: the size of each branch, and the heavy (largest) branch of each room.
+     *  3. Depth first, heavy branch last on the stack (so it is numbered next): the number and the head of each room.
+     */
+    const std::size_t floor_rooms = LENGTH * walls.width();
+    const std::size_t rooms = floor_rooms * walls.height();
+
+    depth.assign(ROOMS, 0);
+    up.assign(ROOMS, 0);
+
+    std::vector<uint32_t> queue(rooms);
+    std::vector<uint64_t> seen((ROOMS + 63) / 64);
+    std::size_t head_at = 0, tail = 0;
+
+    auto not_perfect = []{
+        throw std::invalid_argument("MazeIndex needs a perfect maze.\n");
+    };
+
+    queue[tail++] = 0;
+    seen[0] |= 1;
+    while (head_at < tail){
+        std::size_t i = queue[head_at++];
+        uint8_t back = up[i];
+
+        neighbours(i, [&](std::size_t next, uint8_t move){
+            if (i != 0 && move == back){
+                return;     // The room above
+            }
+            if (next >= ROOMS || next % STRIDE >= floor_rooms || tail == rooms
+                || ((seen[next >> 6] >> (next & 63)) & 1)){
+                not_perfect();
+            }
+            seen[next >> 6] |= uint64_t(1) << (next & 63);
+            depth[next] = depth[i] + 1;
+            up[next] = opposite(move);
+            queue[tail++] = next;
+        });
+    }
+    if (tail != rooms){
+        not_perfect();
+    }
+    std::vector<uint64_t>().swap(seen);
+
+    // Branch sizes, and the move to the heavy branch of each room
+    size.assign(ROOMS, 1);
+    std::vector<uint8_t> heavy(ROOMS, 0);
+    for (std::size_t k = rooms; k-- > 1; ){
+        std::size_t i = queue[k];
+        std::size_t p = parent(i);
+        size[p] += size[i];
+        if (heavy[p] == 0 || size[i] > size[step(p, heavy[p])]){
+            heavy[p] = opposite(up[i]);
+        }
+    }
+
+    // Numbers and heavy path heads, the queue being the stack
+    order.assign(ROOMS, 0);
+    head.assign(ROOMS, 0);
+    std::vector<uint32_t> &stack = queue;
+    std::size_t top = 0;
+    uint32_t number = 0;
+
+    stack[top++] = 0;
+    while (top > 0){
+        std::size_t i = stack[--top];
+        order[i] = number++;
+
+        neighbours(i, [&](std::size_t next, uint8_t move){
+            if ((i != 0 && move == up[i]) || move == heavy[i]){
+                return;
+            }
+            head[next] = next;
+            stack[top++] = next;
+        });
+        if (heavy[i] != 0){
+            std::size_t next = step(i, heavy[i]);
+            head[next] = head[i];
+            stack[top++] = next;
+        }
+    }
+}
+
+std::size_t MazeIndex::room(int row, int col, int floor) const {
+    if (row < 0 || row >= maze.WIDTH || col < 0 || col >= maze.LENGTH || floor < 0 || floor >= maze.HEIGHT){
+        throw std::out_of_range("Room is outside the maze.\n");
+    }
+    return walls.index(row, col, floor);
+}
+
+std::size_t MazeIndex::step(std::size_t i, uint8_t move) const {
+    switch (move){
+        case Maze::EAST:  return i + 1;
+        case Maze::WEST:  return i - 1;
+        case Maze::SOUTH: return i + LENGTH;
+        case Maze::NORTH: return i - LENGTH;
+        case Maze::CEIL:  return i + STRIDE;
+        default:          return i - STRIDE;
+    }
+}
+
+std::size_t MazeIndex::meet(std::size_t a, std::size_t b) const {
+    /* The room where the paths up from a and b meet.
+     * The heavy path with the later head can not hold the meeting room (unless both are on it),
+     * so jump above it. Each jump leaves a light branch, at most halving the rooms below.
+     */
+    while (head[a] != head[b]){
+        if (order[head[a]] > order[head[b]]){
+            a = parent(head[a]);
+        } else {
+            b = parent(head[b]);
+        }
+    }
+    return order[a] < order[b] ? a : b;
+}
+
+uint8_t MazeIndex::first_move(std::size_t from, std::size_t to) const {
+    // Down into the branch holding to, if from's branch holds it. Otherwise up.
+    if (from == to){
+        return 0;
+    }
+    if (!holds(from, to)){
+        return up[from];
+    }
+    uint8_t found = 0;
+    neighbours(from, [&](std::size_t next, uint8_t move){
+        if (move != up[from] && holds(next, to)){
+            found = move;
+        }
+    });
+    return found;
+}
+
+std::size_t MazeIndex::distance(int row, int col, int floor, int to_row, int to_col, int to_floor) const {
+    std::size_t a = room(row, col, floor);
+    std::size_t b = room(to_row, to_col, to_floor);
+    return (std::size_t)depth[a] + depth[b] - 2 * (std::size_t)depth[meet(a, b)];
+}
+
+uint8_t MazeIndex::next_step(int row, int col, int floor, int to_row, int to_col, int to_floor) const {
+    return first_move(room(row, col, floor), room(to_row, to_col, to_floor));
+}
+
+std::vector<uint8_t> MazeIndex::path(int row, int col, int floor, int to_row, int to_col, int to_floor) const {
+    std::size_t a = room(row, col, floor);
+    std::size_t b = room(to_row, to_col, to_floor);
+    std::size_t m = meet(a, b);
+
+    // Up from a to the meeting room, then down the way b came up
+    std::vector<uint8_t> moves;
+    moves.reserve((std::size_t)depth[a] + depth[b] - 2 * (std::size_t)depth[m]);
+    for (std::size_t i = a; i != m; i = parent(i)){
+        moves.push_back(up[i]);
+    }
+    std::size_t middle = moves.size();
+    for (std::size_t i = b; i != m; i = parent(i)){
+        moves.push_back(opposite(up[i]));
+    }
+    std::reverse(moves.begin() + middle, moves.end());
+    return moves;
+}
+
+void MazeIndex::save(const std::string &path) const {
+    // Throws std::runtime_error if the file can not be written.
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file){
+        throw std::runtime_error("Could not create " + path + ".\n");
+    }
+
+    IndexFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version  = VERSION;
+    header.length   = walls.length();
+    header.width    = walls.width();
+    header.height   = walls.height();
+    header.checksum = PackedWalls::checksum(walls.data(), walls.size());
+    header.rooms    = ROOMS;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const std::vector<uint32_t> *numbers : {&depth, &head, &order, &size}){
+        file.write(reinterpret_cast<const char*>(numbers->data()), ROOMS * sizeof(uint32_t));
+    }
+    file.write(reinterpret_cast<const char*>(up.data()), ROOMS);
+
+    if (!file.flush()){
+        throw std::runtime_error("Could not write " + path + ".\n");
+    }
+}
+
+MazeIndex MazeIndex::open(const std::string &path, const Maze &maze){
+    /* Opens an index saved by save(), for the maze it was built from.
+     * Reads the maze's walls once to compare their checksum with the file.
+     */
+    std::ifstream file(path, std::ios::binary);
+    if (!file){
+        throw std::runtime_error("Could not open " + path + ".\n");
+    }
+
+    IndexFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0){
+        throw std::runtime_error(path + " is not a maze index file.\n");
+    }
+    if (header.version != VERSION){
+        throw std::runtime_error(path + " is a maze index file of an unknown version.\n");
+    }
+
+    MazeIndex index(maze, false);
+    const PackedWalls &walls = maze.packed();
+
+    if (header.length != walls.length() || header.width != walls.width() || header.height != walls.height()
+        || header.rooms != index.ROOMS || header.checksum != PackedWalls::checksum(walls.data(), walls.size())){
+        throw std::runtime_error(path + " is the index of another maze.\n");
+    }
+
+    for (std::vector<uint32_t> *numbers : {&index.depth, &index.head, &index.order, &index.size}){
+        numbers->resize(index.ROOMS);
+        file.read(reinterpret_cast<char*>(numbers->data()), index.ROOMS * sizeof(uint32_t));
+    }
+    index.up.resize(index.ROOMS);
+    if (!file.read(reinterpret_cast<char*>(index.up.data()), index.ROOMS)){
+        throw std::runtime_error("Could not read " + path + ".\n");
+    }
+    return index;
+}
+
+MazeIndex::~MazeIndex()
+{
+    // Containers clean up after themselves
+}
@@ -0,0 +1,181 @@
+/*****************************************************************************************
+ **                     3D MAZE - PARALLEL BUILD                                        **
+ **         Carves all floors at the same time, each with one stair up from every       **
+ **         area, then joins the top floor, so the maze stays perfect.                  **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "Maze.h"
+#include "DisjointSet.h"
+#include "ParallelFor.h"
+#include "Bits.h"
+#include <vector>
+#include <algorithm>
+
+namespace {
+    const uint32_t NO_ROOM = UINT32_MAX;
+}
+
+void Maze::build_parallel(unsigned threads){
+    /*      This function generates a maze, using several threads.
+     *
+     *      Phase 1 (in parallel, one floor at a time on each thread):
+     *          Each floor is carved on its own, removing EASTERN and SOUTHERN walls randomly
+     *          between rooms of different sets. This leaves each floor as a forest of rooms (areas).
+     *          Each area below the top floor then gets exactly one passage up,
+     *          from its room with the lowest draw.
+     *              (An area without a passage up would be cut off from the rest of the maze,
+     *               and a second passage up would make a cycle)
+     *          So every area hangs off exactly one area of the floor above, and the areas of
+     *          the top floor hold all of the maze between them.
+     *
+     *      Phase 2 (one thread, linear in the rooms of the top floor):
+     *          On the top floor, walls between rooms of different sets are removed
+     *          until only one set is left.
+     *
+     *      Only phase 2 is serial, and it works on one floor of the maze: With F floors,
+     *      the speedup is bounded by about F (4096x4096x64 carves 64 floors in parallel, then joins one).
+     *      Memory beyond the maze is about 20 bytes per room of a floor for each thread.
+     *
+     *      Each decision only depends on the seed and the room, so the maze is the same for any
+     *      number of threads. (It is not the same maze as build() makes from the same seed)
+     *
+     *      Input:
+     *          unsigned threads - Number of threads to use. 0 uses one per hardware thread.
+     */
+
+    threads = default_threads(threads);
+
+    last_build.clear();
+    MAZE_TIME(last_build.total);
+    {
+        MAZE_TIME(last_build.reset);
+        wall_data.reset(LENGTH, WIDTH, HEIGHT);
+    }
+    EDITED = false;
+
+    // Per thread scratch space for phase 1, and the areas of the top floor for phase 2
+    std::vector<DisjointSet> floor_sets(threads);
+    std::vector<std::vector<uint32_t>> roots(threads);
+    std::vector<FloorAreas> scratch(threads);
+    FloorAreas top;
+
+    parallel_for(HEIGHT, threads, [&](std::size_t floor, unsigned worker){
+        FloorAreas &areas = ((int)floor == HEIGHT - 1) ? top : scratch[worker];
+        carve_floor(floor, floor_sets[worker], areas, roots[worker]);
+    });
+    std::vector<FloorAreas>().swap(scratch);
+    std::vector<std::vector<uint32_t>>().swap(roots);
+    floor_sets.clear();
+
+    // Join the remaining sets on the top floor
+    DisjointSet sets(top.count);
+    for (std::size_t area = 0; area < top.count; area++){
+        sets.add();
+    }
+    std::size_t base = wall_data.index(0, 0, HEIGHT - 1);
+    for (int row = 0; row < WIDTH; row++){
+        for (int col = 0; col < LENGTH; col++){
+            std::size_t i = col + (std::size_t)LENGTH * row;
+
+            if (col < LENGTH - 1 && sets.unite(top.labels[i], top.labels[i + 1])){
+                wall_data.open(PackedWalls::EAST_WORD, base + i);
+            }
+            if (row < WIDTH - 1 && sets.unite(top.labels[i], top.labels[i + LENGTH])){
+                wall_data.open(PackedWalls::SOUTH_WORD, base + i);
+            }
+        }
+    }
+}
+
+void Maze::carve_floor(int floor, DisjointSet &sets, FloorAreas &areas, std::vector<uint32_t> &roots){
+    /* Carves a single floor into a forest, labels each room by its area (tree),
+     * and (below the top floor) opens one passage up from each area.
+     * Only writes to the words of this floor, so floors can be carved at the same time.
+     *
+     *      Output:
+     *          areas.labels[i]    - The area of room i = col + LENGTH*row on this floor.
+     *          areas.pick_room[a] - The room of area a with the lowest PICK_DRAW (the first one on a tie),
+     *          areas.pick_draw[a]   which has the passage up, and its draw. (Not for the top floor)
+     *          areas.count        - The number of areas.
+     */
+    std::size_t floor_size = (std::size_t)LENGTH * WIDTH;
+
+    MazeRandom random(SEED);
+    uint32_t east_limit  = MazeRandom::threshold(EAST_WALL_THRESHOLD);
+    uint32_t south_limit = MazeRandom::threshold(SOUTH_WALL_THRESHOLD);
+
+    sets.reset(floor_size);
+    for (std::size_t i = 0; i < floor_size; i++){
+        sets.add();
+    }
+
+    uint64_t first_room = (uint64_t)floor_size * floor;
+    std::size_t base = wall_data.index(0, 0, floor);
+
+    // The decisions of each row are drawn at once (see MazeRandom::chances),
+    // and only rooms with a passage to try are visited, in the same order as room by room.
+    std::size_t words = (LENGTH + 63) / 64;
+    std::vector<uint64_t> east_chances(words), south_chances(words), either(words);
+
+    for (int row = 0; row < WIDTH; row++){
+        std::size_t first = (std::size_t)LENGTH * row;
+
+        random.chances(first_room + first, MazeRandom::EAST_DRAW, east_limit, LENGTH - 1, east_chances.data());
+        if (row < WIDTH - 1){
+            random.chances(first_room + first, MazeRandom::SOUTH_DRAW, south_limit, LENGTH, south_chances.data());
+        } else {
+            std::fill(south_chances.begin(), south_chances.end(), 0);
+        }
+        for (std::size_t word = 0; word < words; word++){
+            either[word] = east_chances[word] | south_chances[word];
+        }
+
+        for_each_bit(either.data(), words, [&](std::size_t col){
+            std::size_t i = first + col;
+            uint64_t bit = uint64_t(1) << (col & 63);
+
+            if ((east_chances[col >> 6] & bit) && sets.unite(i, i + 1)){
+                wall_data.open(PackedWalls::EAST_WORD, base + i);
+            }
+            if ((south_chances[col >> 6] & bit) && sets.unite(i, i + LENGTH)){
+                wall_data.open(PackedWalls::SOUTH_WORD, base + i);
+            }
+        });
+    }
+
+    // Label the areas 0, 1, 2, ... in order of their first room, and pick the room with the lowest draw in each
+    roots.assign(floor_size, NO_ROOM);
+    areas.labels.resize(floor_size);
+    areas.pick_room.clear();
+    areas.pick_draw.clear();
+
+    const bool picks = floor < HEIGHT - 1;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < floor_size; i++){
+        uint32_t root = sets.find(i);
+        if (roots[root] == NO_ROOM){
+            roots[root] = count++;
+            if (picks){
+                areas.pick_room.push_back(NO_ROOM);
+                areas.pick_draw.push_back(0);
+            }
+        }
+        uint32_t area = roots[root];
+        areas.labels[i] = area;
+
+        if (picks){
+            uint32_t draw = random(first_room + i, MazeRandom::PICK_DRAW);
+            if (areas.pick_room[area] == NO_ROOM || draw < areas.pick_draw[area]){
+                areas.pick_room[area] = i;
+                areas.pick_draw[area] = draw;
+            }
+        }
+    }
+    areas.count = count;
+
+    // One passage up from each area
+    for (uint32_t room : areas.pick_room){
+        wall_data.open(PackedWalls::CEIL_WORD, base + room);
+    }
+}
@@ -0,0 +1,106 @@
+/*****************************************************************************************
+ **                     3D MAZE - PIPELINE                                              **
+ **         Generates a maze on its own thread, handing over each floor when done.      **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazePipeline.h"
+#include "Maze.h"
+#include <algorithm>
+
+MazePipeline::MazePipeline(int columns, int rows, int floors, double horizontal_bias, double vertical_bias,
+                           uint64_t seed, std::size_t queued_floors)
+    : stream(columns, rows, floors, horizontal_bias, vertical_bias, seed),
+      CAPACITY(std::max<std::size_t>(queued_floors, 1)), done(false), stop(false)
+{
+    /* The MazePipeline class constructor
+     *       Input: Same as the Maze constructor, and
+     *           std::size_t queued_floors - Finished floors to hold before the generator waits. (At least 1)
+     *
+     *       Output:
+     *           MazePipeline object, already generating.
+     *
+     *       Throws std::invalid_argument for invalid dimensions or biases (as the Maze constructor).
+     */
+    LENGTH = columns;
+    WIDTH  = rows;
+    HEIGHT = floors;
+
+    generator = std::thread(&MazePipeline::run, this);
+}
+
+void MazePipeline::run(){
+    /* MazeStream hands over the walls one row at a time. They are packed into the blocks of a floor
+     * (as in Maze::build_to_file), and the floor is queued when its last row is in.
+     */
+    Floor current;
+    current.walls = PackedWalls(LENGTH, WIDTH, 1);
+
+    try {
+        stream.generate([&](int row, int floor, const std::vector<uint8_t> &room_walls){
+            if (stop){
+                throw Stopped();
+            }
+            std::size_t i = current.walls.index(row, 0, 0);
+
+            for (int col = 0; col < LENGTH; col++, i++){
+                if (!(room_walls[col] & Maze::EAST))   current.walls.open(PackedWalls::EAST_WORD, i);
+                if (!(room_walls[col] & Maze::SOUTH))  current.walls.open(PackedWalls::SOUTH_WORD, i);
+                if (!(room_walls[col] & Maze::CEIL))   current.walls.open(PackedWalls::CEIL_WORD, i);
+            }
+
+            if (row == WIDTH - 1){
+                current.number = floor;
+
+                std::unique_lock<std::mutex> guard(lock);
+                space_ready.wait(guard, [&]{ return finished.size() < CAPACITY || stop; });
+                if (stop){
+                    throw Stopped();
+                }
+                finished.push_back(std::move(current));
+                floor_ready.notify_one();
+                guard.unlock();
+
+                if (floor < HEIGHT - 1){
+                    current.walls = PackedWalls(LENGTH, WIDTH, 1);
+                }
+            }
+        });
+    } catch (const Stopped &){
+        // Nobody is waiting for the rest
+    } catch (...){
+        std::lock_guard<std::mutex> guard(lock);
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    done = true;
+    floor_ready.notify_one();
+}
+
+bool MazePipeline::next(Floor &floor){
+    std::unique_lock<std::mutex> guard(lock);
+    floor_ready.wait(guard, [&]{ return !finished.empty() || done; });
+
+    if (!finished.empty()){
+        floor = std::move(finished.front());
+        finished.pop_front();
+        space_ready.notify_one();
+        return true;
+    }
+    if (error){
+        std::rethrow_exception(error);
+    }
+    return false;
+}
+
+MazePipeline::~MazePipeline()
+{
+    // Stops the generator (within a row), and waits for it
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+        space_ready.notify_one();
+    }
+    generator.join();
+}
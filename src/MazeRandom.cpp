@@ -0,0 +1,189 @@
+/*****************************************************************************************
+ **                     MAZE RANDOM                                                     **
+ **         Reproducible random decisions, addressed by room instead of by order.       **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeRandom.h"
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+
+// AVX2 versions of draws() and chances(), picked at run time (GCC and Clang on x86)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MAZE_HAVE_AVX2 1
+#endif
+
+namespace {
+#ifdef MAZE_HAVE_AVX2
+    bool avx2_supported(){
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i mix8(__m256i x){
+        // MazeRandom::mix on 8 lanes
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+        x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x7feb352du));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+        x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x846ca68bu));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+        return x;
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i draw8(uint32_t low, uint32_t first_key, uint32_t second_key){
+        // The draws of the rooms low, low + 1, ... low + 7 (all with the same upper half)
+        __m256i rooms = _mm256_add_epi32(_mm256_set1_epi32((int)low), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        __m256i x = mix8(_mm256_xor_si256(rooms, _mm256_set1_epi32((int)first_key)));
+        return mix8(_mm256_xor_si256(x, _mm256_set1_epi32((int)second_key)));
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t draws_avx2(uint32_t low, uint32_t first_key, uint32_t second_key, std::size_t count, uint32_t *out){
+        // Fills whole groups of 8, returns the number of draws made.
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8){
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), draw8(low + (uint32_t)i, first_key, second_key));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t chances_avx2(uint32_t low, uint32_t first_key, uint32_t second_key, uint32_t limit,
+                             std::size_t count, uint64_t *bits){
+        // Fills whole words of 64 bits, returns the number of bits made.
+        // (Unsigned draw < limit is a signed compare with the top bits flipped)
+        const __m256i flip = _mm256_set1_epi32((int)0x80000000u);
+        const __m256i bound = _mm256_xor_si256(_mm256_set1_epi32((int)limit), flip);
+
+        std::size_t i = 0;
+        for (; i + 64 <= count; i += 64){
+            uint64_t word = 0;
+            for (int group = 0; group < 8; group++){
+                __m256i x = _mm256_xor_si256(draw8(low + (uint32_t)(i + 8*group), first_key, second_key), flip);
+                uint32_t below = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(bound, x)));
+                word |= (uint64_t)below << (8*group);
+            }
+            bits[i / 64] = word;
+        }
+        return i;
+    }
+
+    std::atomic<bool> simd_enabled(avx2_supported());
+#else
+    std::atomic<bool> simd_enabled(false);
+#endif
+}
+
+MazeRandom::MazeRandom(uint64_t seed)
+{
+    // Scramble the seed (SplitMix64), so similar seeds give unrelated keys.
+    SEED = seed;
+
+    uint64_t key = seed + 0x9e3779b97f4a7c15ull;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    key =  key ^ (key >> 31);
+
+    KEY_LOW  = (uint32_t)key;
+    KEY_HIGH = (uint32_t)(key >> 32);
+}
+
+uint32_t MazeRandom::threshold(double p){
+    // p * 2^32, kept within range
+    if (p <= 0){
+        return 0;
+    }
+    if (p >= 1){
+        return UINT32_MAX;
+    }
+    return (uint32_t)(p * 4294967296.0);
+}
+
+void MazeRandom::draws(uint64_t room, uint32_t stream, std::size_t count, uint32_t *out) const {
+    /* Same as (*this)(room + i, stream) for each i.
+     * The rooms are taken in runs where the upper 32 bits of the room number stay the same,
+     * so the second key is the same for every room of a run.
+     */
+    uint32_t first_key = KEY_LOW + stream * 0x9e3779b9u;
+
+    std::size_t i = 0;
+    while (i < count){
+        uint64_t start = room + i;
+        uint32_t low = (uint32_t)start;
+        uint32_t second_key = (uint32_t)(start >> 32) ^ KEY_HIGH;
+        std::size_t run = std::min<uint64_t>(count - i, ((uint64_t)1 << 32) - low);
+
+        std::size_t done = 0;
+#ifdef MAZE_HAVE_AVX2
+        if (simd_enabled.load(std::memory_order_relaxed)){
+            done = draws_avx2(low, first_key, second_key, run, out + i);
+        }
+#endif
+        for (; done < run; done++){
+            out[i + done] = mix(mix((low + (uint32_t)done) ^ first_key) ^ second_key);
+        }
+        i += run;
+    }
+}
+
+void MazeRandom::chances(uint64_t room, uint32_t stream, uint32_t limit, std::size_t count, uint64_t *bits) const {
+    // Same as chance(room + i, stream, limit) for each i, as bits. (Runs as in draws())
+    uint32_t first_key = KEY_LOW + stream * 0x9e3779b9u;
+
+    std::fill(bits, bits + (count + 63) / 64, 0);
+
+    std::size_t i = 0;
+    while (i < count){
+        uint64_t start = room + i;
+        uint32_t low = (uint32_t)start;
+        uint32_t second_key = (uint32_t)(start >> 32) ^ KEY_HIGH;
+        std::size_t run = std::min<uint64_t>(count - i, ((uint64_t)1 << 32) - low);
+
+        // The vector code needs runs starting on a word
+        std::size_t done = 0;
+#ifdef MAZE_HAVE_AVX2
+        if (i % 64 == 0 && simd_enabled.load(std::memory_order_relaxed)){
+            done = chances_avx2(low, first_key, second_key, limit, run, bits + i / 64);
+        }
+#endif
+        for (; done < run; done++){
+            if (mix(mix((low + (uint32_t)done) ^ first_key) ^ second_key) < limit){
+                bits[(i + done) / 64] |= uint64_t(1) << ((i + done) % 64);
+            }
+        }
+        i += run;
+    }
+}
+
+bool MazeRandom::simd(){
+    return simd_enabled.load();
+}
+
+void MazeRandom::use_simd(bool enable){
+#ifdef MAZE_HAVE_AVX2
+    simd_enabled = enable && avx2_supported();
+#else
+    (void)enable;
+#endif
+}
+
+uint64_t MazeRandom::random_seed(){
+    // Mixes the time, a call counter and (if available) the system's entropy source.
+    static std::atomic<uint64_t> calls(0);
+
+    uint64_t seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    seed ^= (calls++ + 1) * 0x9e3779b97f4a7c15ull;
+
+    try {
+        std::random_device device;
+        seed ^= ((uint64_t)device() << 32) | device();
+    } catch (const std::exception &){
+        // No entropy source. The time and counter will do.
+    }
+    return seed;
+}
@@ -0,0 +1,231 @@
+/*****************************************************************************************
+ **                     3D MAZE - REGIONS                                               **
+ **         Carves a box of rooms again, in place, keeping the whole maze perfect.      **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "Maze.h"
+#include "DisjointSet.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // Bits of a room's own walls in the copy of the box
+    const uint8_t EAST_BIT  = 1 << PackedWalls::EAST_WORD;
+    const uint8_t SOUTH_BIT = 1 << PackedWalls::SOUTH_WORD;
+    const uint8_t CEIL_BIT  = 1 << PackedWalls::CEIL_WORD;
+}
+
+std::vector<Maze::Room> Maze::regenerate(int row, int col, int floor, int rows, int columns, int floors, uint64_t seed){
+    /*      This function carves a box of rooms again, leaving the rest of the maze as it is.
+     *
+     *      The maze must be perfect. Outside the box, the passages hang off the box's rooms
+     *      at the passages through the box's sides. The box's rooms fall into groups:
+     *      rooms joined by the passages inside the box. Each group ties together
+     *      the parts of the maze outside that reach it.
+     *
+     *      Every wall inside the box is put up, and then knocked down again in random order
+     *      (Kruskal's algorithm), joining any two sets of rooms unless both hold rooms of old groups.
+     *      Every room ends up with exactly one old group, so the box ties the outside together just
+     *      as before, through the same passages out, and the maze stays perfect.
+     *      The passages through the sides of the box are never changed.
+     *
+     *      This keeps more than it has to: the skeletons (the one way inside the box between the passages
+     *      out of a group) stay as they were, rather than only one connection for each part of the
+     *      maze outside. Which passages out lead to the same outside part is only known by walking
+     *      the whole maze, so a box would no longer cost time in proportion to its rooms.
+     *      Boxes with many passages out keep more of their old walls.
+     *
+     *      The walls no longer come from SEED alone, so EDITED is set (and saved with the maze, see MazeFile.h).
+     *
+     *      Time and memory are proportional to the rooms of the box.
+     *
+     *      Input:
+     *          int row, col, floor        - The first room of the box.
+     *          int rows, columns, floors  - The size of the box.
+     *          uint64_t seed              - The same seed on the same maze always carves the same box.
+     *
+     *      Output:
+     *          The rooms whose walls (as given by operator()) changed, in index order.
+     *
+     *      Throws std::out_of_range if the box is not inside the maze,
+     *      and std::length_error for boxes of more than 1431655765 rooms.
+     */
+    if (rows < 1 || columns < 1 || floors < 1 || row < 0 || col < 0 || floor < 0
+        || row + (int64_t)rows > WIDTH || col + (int64_t)columns > LENGTH || floor + (int64_t)floors > HEIGHT){
+        throw std::out_of_range("The region is not inside the maze.\n");
+    }
+    const uint64_t volume = (uint64_t)rows * columns * floors;
+    if (volume * 3 > UINT32_MAX){
+        throw std::length_error("A region can have at most 1431655765 rooms.\n");
+    }
+    wall_data.own();
+
+    const std::size_t n = volume;
+    const std::size_t plane = (std::size_t)rows * columns;
+    const std::size_t stride = wall_data.floor_stride();
+    const std::size_t steps[3] = {1, (std::size_t)columns, plane};
+
+    // Room k of the box is (row + r, col + c, floor + f), k = c + columns*r + columns*rows*f
+    auto index = [&](int r, int c, int f){ return wall_data.index(row + r, col + c, floor + f); };
+
+    // The walls of each room of the box before, and its number of passages to other rooms of the box
+    std::vector<uint8_t> before(n);
+    std::vector<uint8_t> degree(n, 0);
+    std::vector<uint8_t> exit(n, 0);    // Has a passage out of the box
+    std::size_t k = 0;
+
+    for (int f = 0; f < floors; f++){
+        for (int r = 0; r < rows; r++){
+            std::size_t i = index(r, 0, f);
+            for (int c = 0; c < columns; c++, k++, i++){
+                uint8_t walls = 0;
+                if (wall_data.wall(PackedWalls::EAST_WORD, i))   walls |= EAST_BIT;
+                if (wall_data.wall(PackedWalls::SOUTH_WORD, i))  walls |= SOUTH_BIT;
+                if (wall_data.wall(PackedWalls::CEIL_WORD, i))   walls |= CEIL_BIT;
+                before[k] = walls;
+
+                if (c + 1 < columns && !(walls & EAST_BIT)){  degree[k]++; degree[k + 1]++; }
+                if (r + 1 < rows    && !(walls & SOUTH_BIT)){ degree[k]++; degree[k + columns]++; }
+                if (f + 1 < floors  && !(walls & CEIL_BIT)){  degree[k]++; degree[k + plane]++; }
+
+                exit[k] = (c == columns - 1 && !(walls & EAST_BIT))
+                       || (r == rows - 1    && !(walls & SOUTH_BIT))
+                       || (f == floors - 1  && !(walls & CEIL_BIT))
+                       || (c == 0 && col   > 0 && !wall_data.wall(PackedWalls::EAST_WORD, i - 1))
+                       || (r == 0 && row   > 0 && !wall_data.wall(PackedWalls::SOUTH_WORD, i - LENGTH))
+                       || (f == 0 && floor > 0 && !wall_data.wall(PackedWalls::CEIL_WORD, i - stride));
+            }
+        }
+    }
+
+    // Calls visit(other room) for each passage between room at and another room of the box, before
+    auto passages = [&](std::size_t at, auto visit){
+        int c = at % columns, r = at / columns % rows, f = at / plane;
+        if (c + 1 < columns && !(before[at] & EAST_BIT))             visit(at + 1);
+        if (c > 0           && !(before[at - 1] & EAST_BIT))         visit(at - 1);
+        if (r + 1 < rows    && !(before[at] & SOUTH_BIT))            visit(at + columns);
+        if (r > 0           && !(before[at - columns] & SOUTH_BIT))  visit(at - columns);
+        if (f + 1 < floors  && !(before[at] & CEIL_BIT))             visit(at + plane);
+        if (f > 0           && !(before[at - plane] & CEIL_BIT))     visit(at - plane);
+    };
+
+    // The skeletons: Trim the old passages of the box from the dead ends in, up to the rooms with passages out.
+    // What is left of each group is the one way between its passages out. (removed marks the trimmed rooms)
+    std::vector<uint8_t> &removed = degree;     // Reuses degree: 0xff once trimmed
+    const uint8_t TRIMMED = 0xff;
+    std::vector<uint32_t> trim;
+    for (k = 0; k < n; k++){
+        if (degree[k] <= 1 && !exit[k]){
+            trim.push_back(k);
+        }
+    }
+    while (!trim.empty()){
+        std::size_t room = trim.back();
+        trim.pop_back();
+        removed[room] = TRIMMED;
+        passages(room, [&](std::size_t other){
+            if (removed[other] != TRIMMED && --degree[other] == 1 && !exit[other]){
+                trim.push_back(other);
+            }
+        });
+    }
+
+    // One set per room. The skeletons are joined, and held marks the sets holding one.
+    DisjointSet sets(n);
+    std::vector<uint8_t> held(n, 0);
+    for (k = 0; k < n; k++){
+        sets.add();
+        held[k] = exit[k];
+    }
+    std::vector<uint8_t>().swap(exit);
+
+    // Put every other wall inside the box up, and list them (wall 3*k + word belongs to room k)
+    std::vector<uint32_t> inner;
+    inner.reserve(3 * n);
+    k = 0;
+    for (int f = 0; f < floors; f++){
+        for (int r = 0; r < rows; r++){
+            std::size_t i = index(r, 0, f);
+            for (int c = 0; c < columns; c++, k++, i++){
+                const bool inside[3] = {c + 1 < columns, r + 1 < rows, f + 1 < floors};
+                const uint8_t bits[3] = {EAST_BIT, SOUTH_BIT, CEIL_BIT};
+
+                for (int word = 0; word < 3; word++){
+                    if (!inside[word]){
+                        continue;
+                    }
+                    std::size_t other = k + steps[word];
+                    if (!(before[k] & bits[word]) && removed[k] != TRIMMED && removed[other] != TRIMMED){
+                        uint32_t a = sets.find(k), b = sets.find(other);
+                        held[sets.join(a, b)] = held[a] | held[b];
+                    } else {
+                        wall_data.close(word, i);
+                        inner.push_back(3*k + word);
+                    }
+                }
+            }
+        }
+    }
+    std::vector<uint8_t>().swap(degree);
+
+    // Shuffle them (Fisher-Yates, each swap drawn from its place)
+    MazeRandom random(seed);
+    for (std::size_t w = inner.size(); w > 1; w--){
+        std::size_t pick = ((uint64_t)random(w, MazeRandom::REGION_DRAW) * w) >> 32;
+        std::swap(inner[w - 1], inner[pick]);
+    }
+
+    // Kruskal's algorithm, never joining two skeletons
+    for (uint32_t wall : inner){
+        std::size_t room = wall / 3;
+        int word = wall % 3;
+
+        uint32_t a = sets.find(room);
+        uint32_t b = sets.find(room + steps[word]);
+        if (a == b || (held[a] && held[b])){
+            continue;
+        }
+        held[sets.join(a, b)] = held[a] | held[b];
+
+        int c = room % columns;
+        int r = room / columns % rows;
+        int f = room / plane;
+        wall_data.open(word, index(r, c, f));
+    }
+
+    // A room changed if one of its own walls did, or the wall it shares with the room WEST, NORTH or below
+    std::vector<uint8_t> changed(n, 0);
+    k = 0;
+    for (int f = 0; f < floors; f++){
+        for (int r = 0; r < rows; r++){
+            std::size_t i = index(r, 0, f);
+            for (int c = 0; c < columns; c++, k++, i++){
+                uint8_t walls = 0;
+                if (wall_data.wall(PackedWalls::EAST_WORD, i))   walls |= EAST_BIT;
+                if (wall_data.wall(PackedWalls::SOUTH_WORD, i))  walls |= SOUTH_BIT;
+                if (wall_data.wall(PackedWalls::CEIL_WORD, i))   walls |= CEIL_BIT;
+                changed[k] = walls ^ before[k];
+            }
+        }
+    }
+
+    std::vector<Room> rooms;
+    k = 0;
+    for (int f = 0; f < floors; f++){
+        for (int r = 0; r < rows; r++){
+            for (int c = 0; c < columns; c++, k++){
+                if (changed[k]
+                    || (c > 0 && (changed[k - 1] & EAST_BIT))
+                    || (r > 0 && (changed[k - columns] & SOUTH_BIT))
+                    || (f > 0 && (changed[k - plane] & CEIL_BIT))){
+                    rooms.push_back({row + r, col + c, floor + f});
+                }
+            }
+        }
+    }
+    if (!rooms.empty()){
+        EDITED = true;
+    }
+    return rooms;
+}
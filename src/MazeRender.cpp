@@ -0,0 +1,169 @@
+/*****************************************************************************************
+ **                     3D MAZE - PRINTING                                              **
+ **         Draws the maze as text, straight from the wall bits,                        **
+ **         a band of rows at a time into reused buffers.                               **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "Maze.h"
+#include "ParallelFor.h"
+#include <vector>
+#include <cerrno>
+#include <stdexcept>
+#include <algorithm>
+#include <climits>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    // Bytes of text to draw before writing. (Each band is at least one row of rooms)
+    const std::size_t BAND_BYTES = 1 << 20;
+
+    // Room character, by (up | down << 1)
+    const char STAIRS[4] = {' ', 'U', 'D', 'B'};
+
+    // Writes up to size bytes to fd. Returns the bytes written, or a negative number on errors.
+    long write_fd(int fd, const char *text, std::size_t size){
+#ifdef _WIN32
+        return _write(fd, text, (unsigned)std::min<std::size_t>(size, INT_MAX));
+#else
+        return ::write(fd, text, size);
+#endif
+    }
+}
+
+void Maze::print(std::ostream &out, unsigned threads) const {
+    /*  Print the maze to out (std::cout by default)
+     *
+     *  Prints floor in ascending order (top floor last)
+     *  | - represent vertical and horizontal walls respectively
+     *  + is the room corners
+     *  U D B represent stairs up, down, and both, respectively
+     *
+     *  See Maze::render for how the text is made.
+     */
+    render(threads, [&out](const char *text, std::size_t size){
+        out.write(text, size);
+    });
+    out.flush();
+}
+
+void Maze::print(int fd, unsigned threads) const {
+    // Print the maze to a file descriptor. Throws std::runtime_error if writing fails.
+    render(threads, [fd](const char *text, std::size_t size){
+        while (size > 0){
+            long written = write_fd(fd, text, size);
+            if (written < 0){
+                if (errno == EINTR){
+                    continue;
+                }
+                throw std::runtime_error("Could not write the maze.\n");
+            }
+            text += written;
+            size -= written;
+        }
+    });
+}
+
+void Maze::render(unsigned threads, const std::function<void(const char*, std::size_t)> &output) const {
+    /*  Draws the maze, and passes the text to output in large blocks.
+     *
+     *  The floors are split into bands of rows of rooms, each about BAND_BYTES of text.
+     *  Up to threads bands are drawn at the same time, each into a buffer of its own,
+     *  and then written in order. The buffers are reused, so memory use does not
+     *  depend on the size of the maze.
+     */
+    threads = default_threads(threads);
+
+    std::size_t line = 2 * (std::size_t)LENGTH + 2;
+    int band_rows = std::max<std::size_t>(1, BAND_BYTES / (2 * line));
+
+    // The bands, in print order: (floor, first row)
+    std::vector<std::pair<int, int>> bands;
+    std::vector<std::vector<char>> buffers(threads);
+    std::vector<std::size_t> sizes(threads);
+
+    for (int floor = 0; floor < HEIGHT; floor++){
+        for (int row = 0; row < WIDTH; row += band_rows){
+            bands.emplace_back(floor, row);
+
+            bool last = (floor == HEIGHT - 1 && row + band_rows >= WIDTH);
+            if (bands.size() < threads && !last){
+                continue;
+            }
+
+            parallel_for(bands.size(), threads, [&](std::size_t item, unsigned){
+                int first = bands[item].second;
+                int rows  = std::min(band_rows, WIDTH - first);
+
+                buffers[item].resize((2 * (std::size_t)rows + 1) * line + 1);
+                sizes[item] = render_rows(bands[item].first, first, rows, buffers[item].data());
+            });
+
+            for (std::size_t item = 0; item < bands.size(); item++){
+                output(buffers[item].data(), sizes[item]);
+            }
+            bands.clear();
+        }
+    }
+}
+
+std::size_t Maze::render_rows(int floor, int first, int rows, char *text) const {
+    /*  Draws rows [first, first + rows) of a floor into text. Returns the number of bytes drawn.
+     *
+     *  Each row of rooms is a line of rooms and EASTERN walls, and a line of SOUTHERN walls.
+     *  The first row also gets the NORTHERN outer wall, and the last row is followed by an empty line.
+     *  text must have room for (2 * rows + 1) * (2 * LENGTH + 2) + 1 bytes.
+     */
+    char *start = text;
+
+    if (first == 0){
+        *text++ = '+';
+        for (int col = 0; col < LENGTH; col++){
+            *text++ = '-';
+            *text++ = '+';
+        }
+        *text++ = '\n';
+    }
+
+    for (int row = first; row < first + rows; row++){
+        std::size_t i = wall_data.index(row, 0, floor);
+
+        // Rooms and EASTERN walls, 64 rooms at a time
+        *text++ = '|';
+        for (int col = 0; col < LENGTH; col += 64){
+            uint64_t east  = wall_data.bits(PackedWalls::EAST_WORD, i + col);
+            uint64_t up    = ~wall_data.bits(PackedWalls::CEIL_WORD, i + col);
+            uint64_t down  = (floor > 0) ? ~wall_data.bits(PackedWalls::CEIL_WORD, i + col - wall_data.floor_stride()) : 0;
+            int count = std::min(64, LENGTH - col);
+
+            for (int bit = 0; bit < count; bit++){
+                *text++ = STAIRS[((up >> bit) & 1) | ((down >> bit) & 1) << 1];
+                *text++ = ((east >> bit) & 1) ? '|' : ' ';
+            }
+        }
+        *text++ = '\n';
+
+        // SOUTHERN walls
+        *text++ = '+';
+        for (int col = 0; col < LENGTH; col += 64){
+            uint64_t south = wall_data.bits(PackedWalls::SOUTH_WORD, i + col);
+            int count = std::min(64, LENGTH - col);
+
+            for (int bit = 0; bit < count; bit++){
+                *text++ = ((south >> bit) & 1) ? '-' : ' ';
+                *text++ = '+';
+            }
+        }
+        *text++ = '\n';
+    }
+
+    if (first + rows == WIDTH){
+        *text++ = '\n';
+    }
+    return text - start;
+}
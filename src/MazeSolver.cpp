@@ -0,0 +1,343 @@
+/*****************************************************************************************
+ **                     3D MAZE - SOLVER                                                **
+ **         Shortest paths between rooms: breadth first, from both ends, and A*.        **
+ **         Reads the packed wall bits directly.                                        **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeSolver.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+    uint8_t opposite(uint8_t move){
+        switch (move){
+            case Maze::EAST:  return Maze::WEST;
+            case Maze::WEST:  return Maze::EAST;
+            case Maze::NORTH: return Maze::SOUTH;
+            case Maze::SOUTH: return Maze::NORTH;
+            case Maze::CEIL:  return Maze::FLOOR;
+            default:          return Maze::CEIL;
+        }
+    }
+}
+
+MazeSolver::MazeSolver(const Maze &m)
+    : maze(m), walls(m.packed())
+{
+    /* The MazeSolver class constructor
+     *       Input:
+     *           const Maze &m - The maze to search. (Built or opened)
+     *
+     *       Output:
+     *           MazeSolver object. (Search space is allocated when first needed)
+     *
+     * Passages are found from the wall bits alone: The outer walls are never opened,
+     * and the padding at the end of each floor is all walls, so a step west from the
+     * first column (or north from the first row) always hits a wall.
+     */
+    LENGTH = walls.length();
+    STRIDE = walls.floor_stride();
+    ROOMS  = STRIDE * walls.height();
+
+    if (ROOMS > UINT32_MAX){
+        throw std::length_error("MazeSolver can search mazes of at most 4294967295 rooms.\n");
+    }
+}
+
+void MazeSolver::prepare(int side, bool paths){
+    // Allocates the search space of a side, and the way back if paths are wanted.
+    if (seen[side].empty()){
+        seen[side].resize((ROOMS + 63) / 64);
+        queue[side].resize(ROOMS);
+    }
+    if (paths && came[side].empty()){
+        came[side].resize(ROOMS);
+    }
+}
+
+std::size_t MazeSolver::room(int row, int col, int floor) const {
+    if (row < 0 || row >= maze.WIDTH || col < 0 || col >= maze.LENGTH || floor < 0 || floor >= maze.HEIGHT){
+        throw std::out_of_range("Room is outside the maze.\n");
+    }
+    return walls.index(row, col, floor);
+}
+
+void MazeSolver::clear(int side){
+    std::fill(seen[side].begin(), seen[side].end(), 0);
+}
+
+std::size_t MazeSolver::step_back(std::size_t i, uint8_t move) const {
+    // The room the move into i came from
+    switch (move){
+        case Maze::EAST:  return i - 1;
+        case Maze::WEST:  return i + 1;
+        case Maze::SOUTH: return i - LENGTH;
+        case Maze::NORTH: return i + LENGTH;
+        case Maze::CEIL:  return i - STRIDE;
+        default:          return i + STRIDE;
+    }
+}
+
+void MazeSolver::trace(int side, std::size_t from, std::size_t to, std::vector<uint8_t> &moves) const {
+    // Appends the moves from -> to found by the search of side, in order.
+    std::size_t first = moves.size();
+    for (std::size_t i = to; i != from; i = step_back(i, came[side][i])){
+        moves.push_back(came[side][i]);
+    }
+    std::reverse(moves.begin() + first, moves.end());
+}
+
+MazeSolver::Path MazeSolver::bfs(int row, int col, int floor, int to_row, int to_col, int to_floor){
+    std::size_t start = room(row, col, floor);
+    std::size_t goal  = room(to_row, to_col, to_floor);
+
+    Path path = {false, 0, {}, 0};
+    prepare(0, true);
+    clear(0);
+
+    uint32_t *q = queue[0].data();
+    std::size_t head = 0, tail = 0;
+    q[tail++] = start;
+    see(0, start);
+
+    while (head < tail){
+        std::size_t i = q[head++];
+        if (i == goal){
+            path.found = true;
+            break;
+        }
+        neighbours(i, [&](std::size_t next, uint8_t move){
+            if (!is_seen(0, next)){
+                see(0, next);
+                came[0][next] = move;
+                q[tail++] = next;
+            }
+        });
+    }
+
+    path.visited = head;
+    if (path.found){
+        trace(0, start, goal, path.moves);
+        path.length = path.moves.size();
+    }
+    return path;
+}
+
+MazeSolver::Path MazeSolver::bidirectional(int row, int col, int floor, int to_row, int to_col, int to_floor){
+    /* Searches from the start (side 0) and the goal (side 1) at once.
+     * Each round expands a whole level of the side with the smaller frontier, and stops
+     * as soon as the sides touch. A perfect maze has exactly one path, so the first room
+     * found by both sides is on it.
+     */
+    std::size_t ends[2] = {room(row, col, floor), room(to_row, to_col, to_floor)};
+
+    Path path = {false, 0, {}, 0};
+    prepare(0, true);
+    prepare(1, true);
+    clear(0);
+    clear(1);
+
+    std::size_t head[2] = {0, 0}, tail[2] = {0, 0};
+    for (int side = 0; side < 2; side++){
+        queue[side][tail[side]++] = ends[side];
+        see(side, ends[side]);
+    }
+
+    std::size_t meet = ends[0];
+    bool met = (ends[0] == ends[1]);
+
+    while (!met && head[0] < tail[0] && head[1] < tail[1]){
+        int side = (tail[0] - head[0] <= tail[1] - head[1]) ? 0 : 1;
+        int other = 1 - side;
+        uint32_t *q = queue[side].data();
+        std::size_t level_end = tail[side];
+
+        while (!met && head[side] < level_end){
+            std::size_t i = q[head[side]++];
+            neighbours(i, [&](std::size_t next, uint8_t move){
+                if (met || is_seen(side, next)){
+                    return;
+                }
+                see(side, next);
+                came[side][next] = move;
+                q[tail[side]++] = next;
+
+                if (is_seen(other, next)){
+                    met = true;
+                    meet = next;
+                }
+            });
+        }
+    }
+
+    path.visited = head[0] + head[1];
+    if (met){
+        path.found = true;
+        trace(0, ends[0], meet, path.moves);
+
+        // The goal side found meet from the goal: Walk that backwards.
+        std::size_t middle = path.moves.size();
+        trace(1, ends[1], meet, path.moves);
+        std::reverse(path.moves.begin() + middle, path.moves.end());
+        std::transform(path.moves.begin() + middle, path.moves.end(), path.moves.begin() + middle, opposite);
+
+        path.length = path.moves.size();
+    }
+    return path;
+}
+
+MazeSolver::Path MazeSolver::astar(int row, int col, int floor, int to_row, int to_col, int to_floor){
+    /* A* search. The estimate is the number of rows, columns and floors between a room and
+     * the goal, which never overestimates, so the first time the goal leaves the heap its
+     * path is a shortest one.
+     *
+     * The heap is ordered by estimated length, then by most moves made (deepest first),
+     * packed in one key. seen[0] marks rooms reached, seen[1] rooms done.
+     */
+    std::size_t start = room(row, col, floor);
+    std::size_t goal  = room(to_row, to_col, to_floor);
+
+    Path path = {false, 0, {}, 0};
+    prepare(0, true);
+    prepare(1, false);
+    if (cost.empty()){
+        cost.resize(ROOMS);
+    }
+    clear(0);
+    clear(1);
+    heap.clear();
+
+    auto estimate = [&](std::size_t i) -> uint32_t {
+        std::size_t f = i / STRIDE;
+        std::size_t rest = i - f * STRIDE;
+        std::size_t r = rest / LENGTH;
+        std::size_t c = rest - r * LENGTH;
+        return (uint32_t)(std::abs((long long)r - to_row) + std::abs((long long)c - to_col) + std::abs((long long)f - to_floor));
+    };
+    auto key = [](uint32_t moves, uint32_t guess) -> uint64_t {
+        return (uint64_t)(moves + guess) << 32 | (UINT32_MAX - moves);
+    };
+    std::greater<std::pair<uint64_t, std::size_t>> later;
+
+    see(0, start);
+    cost[start] = 0;
+    heap.emplace_back(key(0, estimate(start)), start);
+
+    while (!heap.empty()){
+        std::pop_heap(heap.begin(), heap.end(), later);
+        std::size_t i = heap.back().second;
+        heap.pop_back();
+
+        if (is_seen(1, i)){
+            continue;
+        }
+        see(1, i);
+        path.visited++;
+
+        if (i == goal){
+            path.found = true;
+            break;
+        }
+
+        uint32_t moves = cost[i] + 1;
+        neighbours(i, [&](std::size_t next, uint8_t move){
+            if (is_seen(1, next) || (is_seen(0, next) && cost[next] <= moves)){
+                return;
+            }
+            see(0, next);
+            cost[next] = moves;
+            came[0][next] = move;
+            heap.emplace_back(key(moves, estimate(next)), next);
+            std::push_heap(heap.begin(), heap.end(), later);
+        });
+    }
+
+    if (path.found){
+        trace(0, start, goal, path.moves);
+        path.length = path.moves.size();
+    }
+    return path;
+}
+
+std::size_t MazeSolver::flood(std::size_t start, std::size_t &last, std::size_t &distance){
+    /* Breadth first search from start, a level at a time, through the rooms not yet seen (side 0).
+     * Sets last to a room of the last level, and distance to the number of levels after the first.
+     * Returns the number of rooms reached.
+     */
+    uint32_t *q = queue[0].data();
+    std::size_t head = 0, tail = 0;
+    q[tail++] = start;
+    see(0, start);
+
+    distance = 0;
+    while (true){
+        std::size_t level_end = tail;
+        while (head < level_end){
+            std::size_t i = q[head++];
+            neighbours(i, [&](std::size_t next, uint8_t){
+                if (!is_seen(0, next)){
+                    see(0, next);
+                    q[tail++] = next;
+                }
+            });
+        }
+        if (tail == level_end){
+            break;
+        }
+        distance++;
+    }
+    last = q[tail - 1];
+    return tail;
+}
+
+MazeSolver::Farthest MazeSolver::farthest(int row, int col, int floor){
+    std::size_t start = room(row, col, floor);
+
+    prepare(0, false);
+    clear(0);
+
+    std::size_t last, distance;
+    std::size_t reached = flood(start, last, distance);
+
+    Farthest result;
+    result.floor = last / STRIDE;
+    std::size_t rest = last - (std::size_t)result.floor * STRIDE;
+    result.row = rest / LENGTH;
+    result.col = rest - (std::size_t)result.row * LENGTH;
+    result.distance = distance;
+    result.reached = reached;
+    return result;
+}
+
+std::size_t MazeSolver::components(){
+    // Floods from each room not yet reached, floor by floor, skipping the padding after each floor.
+    prepare(0, false);
+    clear(0);
+
+    std::size_t floor_rooms = LENGTH * maze.WIDTH;
+    std::size_t count = 0;
+    std::size_t last, distance;
+
+    for (int floor = 0; floor < maze.HEIGHT; floor++){
+        std::size_t first = STRIDE * floor;
+        for (std::size_t i = first; i < first + floor_rooms; i++){
+            if ((i & 63) == 0 && i + 64 <= first + floor_rooms && seen[0][i >> 6] == ~uint64_t(0)){
+                i += 63;    // 64 rooms reached already
+                continue;
+            }
+            if (!is_seen(0, i)){
+                flood(i, last, distance);
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+MazeSolver::~MazeSolver()
+{
+    // Containers clean up after themselves
+}
@@ -0,0 +1,121 @@
+/*****************************************************************************************
+ **                     3D MAZE STREAM                                                  **
+ **         Generates a maze one row at a time, without keeping the maze in memory.    **
+ **         Sets are tracked across floors, so any room can reach any other room.      **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeStream.h"
+#include "Maze.h"
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+
+MazeStream::MazeStream(int columns, int rows, int floors, double horizontal_bias, double vertical_bias, uint64_t seed)
+    : eller(columns, rows, floors, 0, 0, seed)
+{
+    /* The MazeStream class contructor
+     *       Input: Same as the Maze constructor.
+     *              The same seed always gives the same maze.
+     *
+     *       Working memory is proportional to columns * rows (one floor of rooms),
+     *       regardless of the number of floors.
+     *
+     *       Output:
+     *           MazeStream object
+     */
+    if (rows < 1 || columns < 1 || floors < 1){
+        std::cout << "A maze must have dimensions greater than zero.\n";
+        throw std::invalid_argument("A maze must have dimensions greater than zero.\n");
+    }
+    if ((uint64_t)rows * (uint64_t)columns > (UINT32_MAX - 1) / 3){
+        throw std::invalid_argument("A maze floor can have at most 1431655764 rooms.\n");
+    }
+    LENGTH = columns;
+    WIDTH  = rows;
+    HEIGHT = floors;
+
+    if (horizontal_bias <= 0 || horizontal_bias >= 1 || vertical_bias <= 0 || vertical_bias >= 1){
+        std::cout << "Biases must be between 0 and 1 exclusive.\n";
+        throw std::invalid_argument("Biases must be between 0 and 1 exclusive.\n");
+    }
+    EAST_WALL_THRESHOLD = horizontal_bias;
+    SOUTH_WALL_THRESHOLD = vertical_bias;
+
+    eller.limits(MazeRandom::threshold(EAST_WALL_THRESHOLD), MazeRandom::threshold(SOUTH_WALL_THRESHOLD));
+}
+
+void MazeStream::generate(const RowSink &sink){
+    /*      This function generates a maze, one row at a time.
+     *
+     *      The live rooms are the rooms that can still get new passages:
+     *      The rooms not yet visited on this floor, and the rooms above the visited ones.
+     *      There is exactly one live room for each (row, col) position, which is stored in the frontier.
+     *      Each live room belongs to a set of rooms connected by passages (possibly through floors below).
+     *
+     *      For each row:
+     *          - Remove EASTERN walls randomly, between rooms of different sets.
+     *          - Remove SOUTHERN walls randomly, between rooms of different sets.
+     *          - Every set that has no live room outside this row must get a passage
+     *              SOUTH or UP from a random room. Otherwise it would be cut off from the rest.
+     *          - The row is finished, and handed to the sink.
+     *          - The rooms above replace the rooms of this row in the frontier.
+     *              (Rooms with a passage up stay in the same set, the others get a new set)
+     *
+     *      On the last row on the last floor, passages between all unconnected sets are made.
+     */
+    std::size_t floor_size = (std::size_t)LENGTH * WIDTH;
+
+    BuildStats &build_stats = eller.stats;
+    build_stats.clear();
+    MAZE_TIME(build_stats.total);
+
+    eller.start();
+    from_below.assign(floor_size, 0);
+    north_open.assign(LENGTH, 0);
+    row_walls.assign(LENGTH, 0);
+
+    for (int floor = 0; floor < HEIGHT; floor++){
+        std::fill(north_open.begin(), north_open.end(), 0);
+
+        for (int row = 0; row < WIDTH; row++){
+            eller.carve_row(row, floor);
+            MAZE_COUNT(build_stats.rows, 1);
+
+            emit_row(row, floor, sink);
+            eller.advance_row(row, floor);
+
+            // The rooms above have a passage down where this row has one up
+            if (floor < HEIGHT - 1){
+                std::copy(eller.up_open.begin(), eller.up_open.end(), from_below.begin() + (std::size_t)LENGTH*row);
+            }
+            std::copy(eller.south_open.begin(), eller.south_open.end(), north_open.begin());
+        }
+    }
+    MAZE_PEAK(build_stats.peak_sets, eller.sets());
+}
+
+void MazeStream::emit_row(int row, int floor, const RowSink &sink){
+    // All walls of this row are now known.
+    MAZE_TIME(eller.stats.emit);
+
+    const auto &east_open = eller.east_open;
+    for (int col = 0; col < LENGTH; col++){
+        uint8_t walls = 63;
+
+        if (east_open[col])                             walls &= ~Maze::EAST;
+        if (col > 0 && east_open[col - 1])              walls &= ~Maze::WEST;
+        if (eller.south_open[col])                      walls &= ~Maze::SOUTH;
+        if (north_open[col])                            walls &= ~Maze::NORTH;
+        if (eller.up_open[col])                         walls &= ~Maze::CEIL;
+        if (from_below[col + (std::size_t)LENGTH*row])  walls &= ~Maze::FLOOR;
+
+        row_walls[col] = walls;
+    }
+    sink(row, floor, row_walls);
+}
+
+MazeStream::~MazeStream()
+{
+    // Containers clean up after themselves
+}
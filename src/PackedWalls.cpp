@@ -0,0 +1,110 @@
+/*****************************************************************************************
+ **                     PACKED WALLS                                                    **
+ **         Stores the walls of a maze using three bits per room.                       **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "PackedWalls.h"
+
+PackedWalls::PackedWalls()
+{
+    // Storage for an empty maze. Use reset() to give it rooms.
+    LENGTH = WIDTH = HEIGHT = 0;
+    FLOOR_STRIDE = 0;
+    blocks = nullptr;
+}
+
+PackedWalls::PackedWalls(int length, int width, int height)
+{
+    reset(length, width, height);
+}
+
+PackedWalls::PackedWalls(const PackedWalls &other)
+{
+    *this = other;
+}
+
+PackedWalls::PackedWalls(PackedWalls &&other)
+{
+    *this = std::move(other);
+}
+
+PackedWalls &PackedWalls::operator=(const PackedWalls &other){
+    // Owned blocks are copied, views are shared.
+    LENGTH = other.LENGTH;
+    WIDTH  = other.WIDTH;
+    HEIGHT = other.HEIGHT;
+    FLOOR_STRIDE = other.FLOOR_STRIDE;
+
+    words = other.words;
+    owner = other.owner;
+    blocks = owner ? other.blocks : words.data();
+    return *this;
+}
+
+PackedWalls &PackedWalls::operator=(PackedWalls &&other){
+    LENGTH = other.LENGTH;
+    WIDTH  = other.WIDTH;
+    HEIGHT = other.HEIGHT;
+    FLOOR_STRIDE = other.FLOOR_STRIDE;
+
+    words = std::move(other.words);
+    owner = std::move(other.owner);
+    blocks = owner ? other.blocks : words.data();
+
+    other.reset(0, 0, 0);
+    return *this;
+}
+
+void PackedWalls::reset(int length, int width, int height){
+    /* Resizes the storage, and puts up all walls.
+     * (Padding bits at the end of each floor are walls as well)
+     */
+    LENGTH = length;
+    WIDTH  = width;
+    HEIGHT = height;
+
+    // Round each floor up to a whole number of blocks
+    FLOOR_STRIDE = ((std::size_t)length*width + 63) & ~(std::size_t)63;
+
+    words.assign(floor_words() * height, ~uint64_t(0));
+    blocks = words.data();
+    owner.reset();
+}
+
+void PackedWalls::view(int length, int width, int height, const uint64_t *data, std::shared_ptr<const void> memory){
+    // Points the storage at data, and lets go of any owned blocks.
+    reset(0, 0, 0);
+    words.shrink_to_fit();
+
+    LENGTH = length;
+    WIDTH  = width;
+    HEIGHT = height;
+    FLOOR_STRIDE = ((std::size_t)length*width + 63) & ~(std::size_t)63;
+
+    blocks = data;
+    owner = memory;
+}
+
+void PackedWalls::own(){
+    if (owner){
+        words.assign(blocks, blocks + size());
+        blocks = words.data();
+        owner.reset();
+    }
+}
+
+uint64_t PackedWalls::checksum(const uint64_t *data, std::size_t count, uint64_t previous){
+    // FNV-1a over whole words. Checksums of consecutive parts can be chained through previous.
+    uint64_t sum = previous;
+    for (std::size_t i = 0; i < count; i++){
+        sum ^= data[i];
+        sum *= 0x100000001b3ull;
+    }
+    return sum;
+}
+
+PackedWalls::~PackedWalls()
+{
+    // Containers clean up after themselves
+}
@@ -0,0 +1,174 @@
+/*****************************************************************************************
+ **                     PAGED MAZE                                                      **
+ **         Reads the rooms of a maze file through a bounded cache of pages,           **
+ **         for mazes larger than memory.                                               **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "PagedMaze.h"
+#include "Maze.h"
+#include "PackedWalls.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#define MAZE_USE_PREAD 1
+#endif
+
+PagedMaze::PagedMaze(const std::string &file_path, std::size_t memory_budget)
+    : path(file_path), fd(-1)
+{
+    /* The PagedMaze class constructor
+     *       Input:
+     *           const std::string &file_path - A maze file.
+     *           std::size_t memory_budget    - Bytes to spend on cached pages.
+     *
+     *       Output:
+     *           PagedMaze object. Only the header is read.
+     *
+     *       Throws std::runtime_error if the file can not be read, or is not a valid maze file.
+     */
+    uint64_t size;
+
+#ifdef MAZE_USE_PREAD
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        throw std::runtime_error("Could not open " + path + ".\n");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(header)
+        || ::pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)){
+        ::close(fd);
+        throw std::runtime_error(path + " is not a maze file.\n");
+    }
+    size = info.st_size;
+#else
+    file.open(path, std::ios::binary | std::ios::ate);
+    if (!file){
+        throw std::runtime_error("Could not open " + path + ".\n");
+    }
+    size = file.tellg();
+    file.seekg(0);
+    if (size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))){
+        throw std::runtime_error(path + " is not a maze file.\n");
+    }
+#endif
+
+    try {
+        header.check(size, path);
+    } catch (...){
+#ifdef MAZE_USE_PREAD
+        ::close(fd);
+#endif
+        throw;
+    }
+
+    LENGTH = header.length;
+    WIDTH  = header.width;
+    HEIGHT = header.height;
+    SEED   = header.seed;
+    EDITED = header.flags & MazeFileHeader::EDITED;
+
+    FLOOR_STRIDE = ((uint64_t)LENGTH * WIDTH + 63) & ~(uint64_t)63;
+    WORDS = header.data_words();
+
+    std::size_t page_bytes = PAGE_BLOCKS * 3 * sizeof(uint64_t) + 2 * sizeof(uint64_t) + 6 * sizeof(void*);
+    CAPACITY = std::max<std::size_t>(1, memory_budget / page_bytes);
+}
+
+void PagedMaze::read(uint64_t word, std::size_t count, uint64_t *out){
+    // Reads count words of blocks, starting at word. (The lock must be held)
+    uint64_t offset = sizeof(header) + word * sizeof(uint64_t);
+    std::size_t bytes = count * sizeof(uint64_t);
+
+#ifdef MAZE_USE_PREAD
+    char *to = reinterpret_cast<char*>(out);
+    while (bytes > 0){
+        ssize_t done = ::pread(fd, to, bytes, offset);
+        if (done <= 0){
+            throw std::runtime_error("Could not read " + path + ".\n");
+        }
+        to += done;
+        offset += done;
+        bytes -= done;
+    }
+#else
+    file.seekg(offset);
+    if (!file.read(reinterpret_cast<char*>(out), bytes)){
+        throw std::runtime_error("Could not read " + path + ".\n");
+    }
+#endif
+}
+
+const std::vector<uint64_t> &PagedMaze::page(uint64_t number){
+    // Finds the page in the cache, or reads it. (The lock must be held)
+    auto found = page_index.find(number);
+    if (found != page_index.end()){
+        pages.splice(pages.begin(), pages, found->second);
+        return found->second->second;
+    }
+
+    // Reuse the memory of the oldest page
+    std::vector<uint64_t> words;
+    if (pages.size() >= CAPACITY){
+        page_index.erase(pages.back().first);
+        words.swap(pages.back().second);
+        pages.pop_back();
+    }
+
+    uint64_t first = number * PAGE_BLOCKS * 3;
+    words.resize(std::min<uint64_t>(PAGE_BLOCKS * 3, WORDS - first));
+    read(first, words.size(), words.data());
+
+    pages.emplace_front(number, std::move(words));
+    page_index[number] = pages.begin();
+
+    return pages.front().second;
+}
+
+bool PagedMaze::wall(int word, uint64_t index){
+    // Is the wall (PackedWalls::EAST_WORD, SOUTH_WORD or CEIL_WORD) of the room at index up? (The lock must be held)
+    uint64_t block = index >> 6;
+    const std::vector<uint64_t> &words = page(block / PAGE_BLOCKS);
+    return (words[(block % PAGE_BLOCKS)*3 + word] >> (index & 63)) & 1;
+}
+
+int PagedMaze::operator()(int row, int col, int floor){
+    if (row < 0 || row >= WIDTH || col < 0 || col >= LENGTH || floor < 0 || floor >= HEIGHT){
+        throw std::out_of_range("Room is outside the maze.\n");
+    }
+    uint64_t i = col + (uint64_t)LENGTH*row + FLOOR_STRIDE*floor;
+
+    std::lock_guard<std::mutex> guard(lock);
+    return PackedWalls::room_walls([this](int word, uint64_t index){ return wall(word, index); },
+                                   i, row, col, floor, LENGTH, FLOOR_STRIDE);
+}
+
+bool PagedMaze::verify(){
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::vector<uint64_t> words(PAGE_BLOCKS * 3);
+    uint64_t sum = PackedWalls::checksum(nullptr, 0);
+
+    for (uint64_t first = 0; first < WORDS; first += words.size()){
+        std::size_t count = std::min<uint64_t>(words.size(), WORDS - first);
+        read(first, count, words.data());
+        sum = PackedWalls::checksum(words.data(), count, sum);
+    }
+    return sum == header.checksum;
+}
+
+std::size_t PagedMaze::cached_pages(){
+    std::lock_guard<std::mutex> guard(lock);
+    return pages.size();
+}
+
+PagedMaze::~PagedMaze()
+{
+#ifdef MAZE_USE_PREAD
+    ::close(fd);
+#endif
+}
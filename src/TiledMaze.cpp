@@ -0,0 +1,203 @@
+/*****************************************************************************************
+ **                     TILED MAZE                                                      **
+ **         An endless perfect maze, built one tile at a time, on demand.               **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "TiledMaze.h"
+#include <tuple>
+#include <stdexcept>
+
+namespace {
+    // Directions a tile can link to
+    const int NO_LINK    = 0;
+    const int WEST_LINK  = 1;
+    const int NORTH_LINK = 2;
+    const int DOWN_LINK  = 3;
+}
+
+TiledMaze::TiledMaze(int tile_columns, int tile_rows, int tile_floors, double horizontal_bias, double vertical_bias,
+                     uint64_t seed, std::size_t memory_budget)
+    : random(seed)
+{
+    /* The TiledMaze class contructor
+     *       Input:
+     *           int tile_columns, tile_rows, tile_floors - The size of each tile. (As for Maze)
+     *           double horizontal_bias, vertical_bias    - Used for each tile. (As for Maze)
+     *           uint64_t seed                            - The same seed always gives the same maze.
+     *           std::size_t memory_budget                - Bytes to spend on cached tiles.
+     *
+     *       Output:
+     *           TiledMaze object
+     */
+    if (tile_rows < 1 || tile_columns < 1 || tile_floors < 1){
+        throw std::invalid_argument("A maze must have dimensions greater than zero.\n");
+    }
+    if (horizontal_bias <= 0 || horizontal_bias >= 1 || vertical_bias <= 0 || vertical_bias >= 1){
+        throw std::invalid_argument("Biases must be between 0 and 1 exclusive.\n");
+    }
+    TILE_LENGTH = tile_columns;
+    TILE_WIDTH  = tile_rows;
+    TILE_HEIGHT = tile_floors;
+    SEED = seed;
+
+    EAST_WALL_THRESHOLD  = horizontal_bias;
+    SOUTH_WALL_THRESHOLD = vertical_bias;
+
+    // Walls of a tile, and the bookkeeping around it
+    std::size_t tile_bytes = PackedWalls(TILE_LENGTH, TILE_WIDTH, TILE_HEIGHT).size() * sizeof(uint64_t)
+                           + sizeof(Maze) + sizeof(TileKey) + 4 * sizeof(void*);
+
+    CAPACITY = std::max<std::size_t>(1, memory_budget / tile_bytes);
+}
+
+std::size_t TiledMaze::TileHash::operator()(const TileKey &key) const {
+    return tile_number(key);
+}
+
+uint64_t TiledMaze::tile_number(const TileKey &key){
+    // Hashes the tile coordinates to a single number (SplitMix64 finalizer)
+    uint64_t x = key.col * 0x9e3779b97f4a7c15ull ^ key.row * 0xc2b2ae3d27d4eb4full ^ key.floor * 0x165667b19e3779f9ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+int TiledMaze::link(const TileKey &key) const {
+    /* The direction of the one tile this tile is linked to.
+     *
+     * Each tile links WEST, NORTH or down, to a tile closer to the first tile (0, 0, 0).
+     * Following the links from any tile ends in the first tile, so the tiles form a tree.
+     */
+    int options[3];
+    int count = 0;
+
+    if (key.col   > 0) options[count++] = WEST_LINK;
+    if (key.row   > 0) options[count++] = NORTH_LINK;
+    if (key.floor > 0) options[count++] = DOWN_LINK;
+
+    if (count == 0){
+        return NO_LINK;
+    }
+    return options[random(tile_number(key), MazeRandom::LINK_DRAW) % count];
+}
+
+bool TiledMaze::door(const TileKey &key, int direction, int a, int b) const {
+    /* Is there a door out of the tile's WEST, NORTH or lower side, at (a, b) on that side?
+     *      WEST side:  (row, floor)
+     *      NORTH side: (col, floor)
+     *      Down side:  (row, col)
+     */
+    if (key.row < 0 || key.col < 0 || key.floor < 0 || link(key) != direction){
+        return false;
+    }
+    uint32_t draw = random(tile_number(key), MazeRandom::DOOR_DRAW);
+
+    switch (direction){
+        case WEST_LINK:
+            return draw % ((uint64_t)TILE_WIDTH * TILE_HEIGHT) == (uint64_t)a + (uint64_t)TILE_WIDTH * b;
+        case NORTH_LINK:
+            return draw % ((uint64_t)TILE_LENGTH * TILE_HEIGHT) == (uint64_t)a + (uint64_t)TILE_LENGTH * b;
+        default:
+            return draw % ((uint64_t)TILE_WIDTH * TILE_LENGTH) == (uint64_t)b + (uint64_t)TILE_LENGTH * a;
+    }
+}
+
+const Maze &TiledMaze::tile(const TileKey &key){
+    // Finds the tile in the cache, or builds it. (The lock must be held)
+    auto found = tile_index.find(key);
+    if (found != tile_index.end()){
+        tiles.splice(tiles.begin(), tiles, found->second);
+        return found->second->second;
+    }
+
+    if (tiles.size() >= CAPACITY){
+        tile_index.erase(tiles.back().first);
+        tiles.pop_back();
+    }
+
+    uint64_t number = tile_number(key);
+    uint64_t seed = ((uint64_t)random(number, MazeRandom::SEED_DRAW) << 32) | random(number, MazeRandom::SEED_DRAW + 1);
+
+    tiles.emplace_front(std::piecewise_construct,
+                        std::forward_as_tuple(key),
+                        std::forward_as_tuple(TILE_LENGTH, TILE_WIDTH, TILE_HEIGHT, EAST_WALL_THRESHOLD, SOUTH_WALL_THRESHOLD, seed));
+    try {
+        tiles.front().second.build();
+    } catch (...){
+        tiles.pop_front();
+        throw;
+    }
+    tile_index[key] = tiles.begin();
+
+    return tiles.front().second;
+}
+
+int TiledMaze::room(int64_t row, int64_t col, int64_t floor, const Maze *&last, TileKey &last_key){
+    /* The walls of a room. (The lock must be held)
+     * last and last_key remember the tile of the previous room, to skip the cache lookup.
+     */
+    if (row < 0 || col < 0 || floor < 0){
+        throw std::out_of_range("Room is outside the maze.\n");
+    }
+    TileKey key = {row / TILE_WIDTH, col / TILE_LENGTH, floor / TILE_HEIGHT};
+    int r = row % TILE_WIDTH;
+    int c = col % TILE_LENGTH;
+    int f = floor % TILE_HEIGHT;
+
+    if (last == nullptr || !(key == last_key)){
+        last = &tile(key);
+        last_key = key;
+    }
+    int value = (*last)(r, c, f);
+
+    // The outer walls of the tile are all up, except the doors to linked tiles.
+    if (c == TILE_LENGTH - 1 && door({key.row, key.col + 1, key.floor}, WEST_LINK, r, f))   value &= ~Maze::EAST;
+    if (c == 0               && door(key, WEST_LINK, r, f))                                 value &= ~Maze::WEST;
+    if (r == TILE_WIDTH - 1  && door({key.row + 1, key.col, key.floor}, NORTH_LINK, c, f))  value &= ~Maze::SOUTH;
+    if (r == 0               && door(key, NORTH_LINK, c, f))                                value &= ~Maze::NORTH;
+    if (f == TILE_HEIGHT - 1 && door({key.row, key.col, key.floor + 1}, DOWN_LINK, r, c))   value &= ~Maze::CEIL;
+    if (f == 0               && door(key, DOWN_LINK, r, c))                                 value &= ~Maze::FLOOR;
+
+    return value;
+}
+
+int TiledMaze::operator()(int64_t row, int64_t col, int64_t floor){
+    std::lock_guard<std::mutex> guard(lock);
+
+    const Maze *last = nullptr;
+    TileKey last_key;
+    return room(row, col, floor, last, last_key);
+}
+
+void TiledMaze::region(int64_t row, int64_t col, int64_t floor, int rows, int columns, int floors, std::vector<uint8_t> &walls){
+    // Reads a box of rooms. Each tile in the box is only looked up once per row of rooms.
+    if (rows < 0 || columns < 0 || floors < 0){
+        throw std::invalid_argument("A region can not have negative dimensions.\n");
+    }
+    walls.resize((std::size_t)rows * columns * floors);
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    const Maze *last = nullptr;
+    TileKey last_key;
+    std::size_t i = 0;
+
+    for (int f = 0; f < floors; f++){
+        for (int r = 0; r < rows; r++){
+            for (int c = 0; c < columns; c++){
+                walls[i++] = room(row + r, col + c, floor + f, last, last_key);
+            }
+        }
+    }
+}
+
+std::size_t TiledMaze::cached_tiles(){
+    std::lock_guard<std::mutex> guard(lock);
+    return tiles.size();
+}
+
+TiledMaze::~TiledMaze()
+{
+    // Containers clean up after themselves
+}
@@ -0,0 +1,37 @@
+/*****************************************************************************************
+ **                     CHECKS - PARALLEL BUILD                                         **
+ **         build_parallel makes a perfect maze, the same one for any number of         **
+ **         threads, and the same one again when the maze is built twice.               **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeAnalysis.h"
+
+int main()
+{
+    const int sizes[][3] = {{1, 1, 1}, {1, 1, 9}, {7, 5, 4}, {64, 3, 9}, {65, 33, 5}, {3, 100, 2}, {20, 20, 1}};
+
+    for (auto &size : sizes){
+        for (uint64_t seed : {1ull, 7ull, 123456789ull}){
+            for (double bias : {0.1, 0.5, 0.9}){
+                Maze single(size[0], size[1], size[2], bias, 1 - bias, seed);
+                single.build_parallel(1);
+                const std::vector<uint8_t> walls = room_walls(single);
+                CHECK(perfect_box(walls, size[0], size[1], size[2]));
+                CHECK(MazeAnalysis(single).perfect());
+
+                for (unsigned threads : {2u, 3u, 8u, 0u}){
+                    Maze maze(size[0], size[1], size[2], bias, 1 - bias, seed);
+                    maze.build_parallel(threads);
+                    CHECK(room_walls(maze) == walls);
+                }
+
+                // Building again (over the old walls) gives the same maze
+                single.build_parallel(4);
+                CHECK(room_walls(single) == walls);
+            }
+        }
+    }
+    return check_result();
+}
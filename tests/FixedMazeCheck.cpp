@@ -0,0 +1,105 @@
+/*****************************************************************************************
+ **                     CHECKS - FIXED MAZE                                             **
+ **         FixedMaze builds the same maze as Maze, bit for bit,                        **
+ **         and works wherever a Maze does through its view.                            **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "FixedMaze.h"
+#include "MazeAnalysis.h"
+#include "MazeSolver.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <sstream>
+
+namespace {
+    std::string file_bytes(const std::string &path){
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    template<int L, int W, int H>
+    void check_size(uint64_t seed){
+        static FixedMaze<L, W, H> fixed(0.45, 0.6, seed);
+        fixed = FixedMaze<L, W, H>(0.45, 0.6, seed);
+        fixed.build();
+
+        Maze maze(L, W, H, 0.45, 0.6, seed);
+        maze.build();
+
+        // Same blocks, and the same answers through every way of reading them
+        CHECK(std::equal(fixed.data().begin(), fixed.data().end(), maze.packed().data()));
+        CHECK(fixed.packed().size() == maze.packed().size());
+        CHECK(std::equal(fixed.data().begin(), fixed.data().end(), fixed.packed().data()));
+        CHECK(room_walls(fixed.maze()) == room_walls(maze));
+
+        bool rooms_agree = true;
+        for (int f = 0; f < H; f++){
+            for (int r = 0; r < W; r++){
+                for (int c = 0; c < L; c++){
+                    rooms_agree &= fixed(r, c, f) == maze(r, c, f);
+                }
+            }
+        }
+        CHECK(rooms_agree);
+
+        // The view works where a Maze does
+        Maze view = fixed.maze();
+        CHECK(MazeAnalysis(view).perfect());
+        MazeSolver solver(view);
+        CHECK(solver.bfs(0, 0, 0, W - 1, L - 1, H - 1).length == MazeSolver(maze).bfs(0, 0, 0, W - 1, L - 1, H - 1).length);
+
+        std::ostringstream fixed_text, maze_text;
+        fixed.print(fixed_text);
+        maze.print(maze_text);
+        CHECK(fixed_text.str() == maze_text.str());
+
+        fixed.save("FixedMazeCheck.fixed.maze");
+        maze.save("FixedMazeCheck.maze");
+        CHECK(file_bytes("FixedMazeCheck.fixed.maze") == file_bytes("FixedMazeCheck.maze"));
+        std::remove("FixedMazeCheck.fixed.maze");
+        std::remove("FixedMazeCheck.maze");
+    }
+    // A maze built in memory full of stale bytes (not zeroed as the static one above is)
+    template<int L, int W, int H>
+    void check_dirty(uint64_t seed){
+        typedef FixedMaze<L, W, H> Fixed;
+        std::vector<unsigned char> memory(sizeof(Fixed) + alignof(Fixed), 0xa5);
+        void *place = memory.data();
+        std::size_t space = memory.size();
+        Fixed *fixed = new (std::align(alignof(Fixed), sizeof(Fixed), place, space)) Fixed(0.45, 0.6, seed);
+        fixed->build();
+
+        Maze maze(L, W, H, 0.45, 0.6, seed);
+        maze.build();
+        CHECK(std::equal(fixed->data().begin(), fixed->data().end(), maze.packed().data()));
+        fixed->~Fixed();
+
+        Fixed on_stack(0.45, 0.6, seed);
+        on_stack.build();
+        CHECK(std::equal(on_stack.data().begin(), on_stack.data().end(), maze.packed().data()));
+    }
+}
+
+int main()
+{
+    for (uint64_t seed : {1ull, 2ull, 99999ull}){
+        check_size<1, 1, 1>(seed);
+        check_size<10, 5, 4>(seed);
+        check_size<64, 3, 3>(seed);
+        check_size<65, 9, 2>(seed);
+        check_size<16, 16, 4>(seed);
+        check_size<3, 70, 5>(seed);
+
+        // Rows of 64 * n + 1 rooms draw one word of EAST chances less than they read
+        check_dirty<1, 5, 3>(seed);
+        check_dirty<65, 4, 2>(seed);
+        check_dirty<129, 3, 2>(seed);
+    }
+    return check_result();
+}
@@ -0,0 +1,47 @@
+/*****************************************************************************************
+ **                     CHECKS - GENERATORS                                             **
+ **         Every generator carves a perfect maze, the same one for the same seed,      **
+ **         and EllerGenerator carves the maze of Maze::build().                        **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeGenerator.h"
+#include "MazeAnalysis.h"
+#include <memory>
+
+int main()
+{
+    std::vector<std::unique_ptr<MazeGenerator>> generators;
+    generators.emplace_back(new EllerGenerator());
+    generators.emplace_back(new KruskalGenerator());
+    generators.emplace_back(new WilsonGenerator());
+    for (double newest : {0.0, 0.25, 0.5, 0.9, 1.0}){
+        generators.emplace_back(new GrowingTreeGenerator(newest));
+    }
+
+    const int sizes[][3] = {{1, 1, 1}, {12, 9, 4}, {1, 40, 1}, {70, 3, 2}};
+    for (auto &size : sizes){
+        for (auto &generator : generators){
+            for (uint64_t seed = 1; seed <= 5; seed++){
+                Maze maze(size[0], size[1], size[2], 0.4, 0.6, seed);
+                maze.build(*generator);
+                std::vector<uint8_t> walls = room_walls(maze);
+                CHECK(perfect_box(walls, size[0], size[1], size[2]));
+                CHECK(MazeAnalysis(maze).perfect());
+
+                Maze again(size[0], size[1], size[2], 0.4, 0.6, seed);
+                again.build(*generator);
+                CHECK(room_walls(again) == walls);
+            }
+        }
+
+        Maze eller(size[0], size[1], size[2], 0.4, 0.6, 77);
+        Maze plain(size[0], size[1], size[2], 0.4, 0.6, 77);
+        eller.build(EllerGenerator());
+        plain.build();
+        CHECK(room_walls(eller) == room_walls(plain));
+    }
+
+    return check_result();
+}
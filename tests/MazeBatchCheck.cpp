@@ -0,0 +1,64 @@
+/*****************************************************************************************
+ **                     CHECKS - BATCHES                                                **
+ **         Each maze of a batch is the Maze of its seed, for any number of threads,    **
+ **         and the batch's pool runs every item exactly once, call after call.         **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeBatch.h"
+#include "MazeAnalysis.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+int main()
+{
+    const int sizes[][3] = {{16, 16, 4}, {1, 1, 1}, {7, 3, 5}, {65, 2, 2}};
+
+    for (auto &size : sizes){
+        MazeBatch batch(size[0], size[1], size[2], 0.5, 0.35);
+
+        // The pool grows, shrinks and grows again between calls
+        for (unsigned threads : {1u, 4u, 2u, 4u}){
+            std::vector<uint64_t> seeds;
+            for (uint64_t seed = 0; seed < 40; seed++){
+                seeds.push_back(seed * 7919 + threads);
+            }
+            batch.generate(seeds, threads);
+            CHECK(batch.size() == seeds.size());
+
+            for (std::size_t i = 0; i < seeds.size(); i++){
+                Maze maze(size[0], size[1], size[2], 0.5, 0.35, seeds[i]);
+                maze.build();
+                CHECK(std::equal(maze.packed().data(), maze.packed().data() + batch.maze_words(), batch.data(i)));
+
+                Maze view = Maze::view(size[0], size[1], size[2], 0.5, 0.35, seeds[i], batch.data(i),
+                                       std::shared_ptr<const void>(batch.data(i), [](const void*){}));
+                CHECK(MazeAnalysis(view).perfect());
+                CHECK(room_walls(view) == room_walls(maze));
+            }
+        }
+    }
+
+    // Every item once, and the first exception comes back to the caller
+    WorkerPool pool;
+    for (unsigned round = 0; round < 200; round++){
+        std::vector<int> hits(1000, 0);
+        pool.parallel_for(hits.size(), 1 + round % 5, [&](std::size_t item, unsigned){ hits[item]++; });
+        CHECK(std::count(hits.begin(), hits.end(), 1) == (long)hits.size());
+    }
+    bool thrown = false;
+    try {
+        pool.parallel_for(100, 3, [](std::size_t item, unsigned){
+            if (item == 42){
+                throw std::runtime_error("item 42");
+            }
+        });
+    } catch (const std::runtime_error &){
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    return check_result();
+}
@@ -0,0 +1,79 @@
+#ifndef MAZECHECKS_H
+#define MAZECHECKS_H
+
+/* Small helpers shared by the checks in this directory (run them with ctest).
+ * Each check is a program that returns 0 when all of its CHECKs hold.
+ */
+
+#include<iostream>
+#include<vector>
+#include<cstdint>
+#include "Maze.h"
+#include "DisjointSet.h"
+
+static int check_failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)){ \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            check_failures++; \
+        } \
+    } while (0)
+
+// Returns the exit code of a check program
+inline int check_result(){
+    if (check_failures == 0){
+        std::cout << "All checks passed\n";
+    }
+    return check_failures == 0 ? 0 : 1;
+}
+
+/* Is the box of rooms a perfect maze on its own (connected and without loops, using the passages inside the box)?
+ * walls[c + columns*r + columns*rows*f] holds the walls of each room, as bits (Maze::FLOOR, Maze::EAST, ...).
+ */
+inline bool perfect_box(const std::vector<uint8_t> &walls, int columns, int rows, int floors){
+    const std::size_t plane = (std::size_t)columns * rows;
+    DisjointSet sets(walls.size());
+    for (std::size_t k = 0; k < walls.size(); k++){
+        sets.add();
+    }
+
+    std::size_t passages = 0;
+    for (int f = 0; f < floors; f++){
+        for (int r = 0; r < rows; r++){
+            for (int c = 0; c < columns; c++){
+                std::size_t k = c + (std::size_t)columns * r + plane * f;
+                const std::size_t next[3] = {k + 1, k + columns, k + plane};
+                const bool open[3] = {c + 1 < columns && !(walls[k] & Maze::EAST),
+                                      r + 1 < rows    && !(walls[k] & Maze::SOUTH),
+                                      f + 1 < floors  && !(walls[k] & Maze::CEIL)};
+                for (int d = 0; d < 3; d++){
+                    if (open[d]){
+                        passages++;
+                        if (!sets.unite(k, next[d])){
+                            return false;   // A loop
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return passages + 1 == walls.size();
+}
+
+// The walls of every room of a maze, in the order of perfect_box
+inline std::vector<uint8_t> room_walls(const Maze &maze){
+    std::vector<uint8_t> walls;
+    walls.reserve((std::size_t)maze.LENGTH * maze.WIDTH * maze.HEIGHT);
+    for (int f = 0; f < maze.HEIGHT; f++){
+        for (int r = 0; r < maze.WIDTH; r++){
+            for (int c = 0; c < maze.LENGTH; c++){
+                walls.push_back(maze(r, c, f));
+            }
+        }
+    }
+    return walls;
+}
+
+#endif // MAZECHECKS_H
@@ -0,0 +1,90 @@
+/*****************************************************************************************
+ **                     CHECKS - MAZE FILES                                             **
+ **         Saved mazes open as the same maze, and broken files are refused.            **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeFile.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    const std::string PATH = "MazeFileCheck.maze";
+
+    // Overwrites the header of the maze file at PATH
+    void change_header(void (*change)(MazeFileHeader&)){
+        std::fstream file(PATH, std::ios::binary | std::ios::in | std::ios::out);
+        MazeFileHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        change(header);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    bool opens(bool verify){
+        try {
+            Maze::open(PATH, verify);
+            return true;
+        } catch (const std::runtime_error &){
+            return false;
+        }
+    }
+}
+
+int main()
+{
+    const int sizes[][3] = {{1, 1, 1}, {10, 5, 4}, {64, 2, 3}, {65, 7, 2}};
+
+    for (auto &size : sizes){
+        Maze maze(size[0], size[1], size[2], 0.4, 0.6, 12345);
+        maze.build();
+        maze.save(PATH);
+
+        Maze loaded = Maze::open(PATH, true);
+        CHECK(loaded.LENGTH == maze.LENGTH && loaded.WIDTH == maze.WIDTH && loaded.HEIGHT == maze.HEIGHT);
+        CHECK(loaded.SEED == maze.SEED);
+        CHECK(room_walls(loaded) == room_walls(maze));
+
+        // Building an opened maze again gives the maze of its seed
+        loaded.build();
+        CHECK(room_walls(loaded) == room_walls(maze));
+    }
+
+    // Biases the constructor would refuse
+    change_header([](MazeFileHeader &header){ header.horizontal_bias = 1.5; });
+    CHECK(!opens(false));
+
+    // Changed walls
+    Maze maze(10, 5, 4, 0.5, 0.5, 1);
+    maze.build();
+    maze.save(PATH);
+    change_header([](MazeFileHeader &header){ header.checksum ^= 1; });
+    CHECK(opens(false));
+    CHECK(!opens(true));
+
+    // Saving (or building) over the file a maze was opened from, while it reads from it
+    {
+        Maze first(33, 7, 3, 0.4, 0.6, 5);
+        first.build();
+        first.save(PATH);
+
+        Maze opened = Maze::open(PATH);
+        opened.save(PATH);
+        CHECK(room_walls(opened) == room_walls(first));
+        CHECK(room_walls(Maze::open(PATH, true)) == room_walls(first));
+
+        opened.regenerate(1, 2, 0, 4, 20, 2, 9);
+        opened.save(PATH);
+        CHECK(room_walls(Maze::open(PATH, true)) == room_walls(opened));
+
+        Maze again = Maze::open(PATH);
+        Maze::build_to_file(PATH, 33, 7, 3, 0.4, 0.6, 5);
+        CHECK(room_walls(again) == room_walls(opened));
+        CHECK(room_walls(Maze::open(PATH, true)) == room_walls(first));
+        CHECK(!std::ifstream(PATH + ".partial"));
+    }
+
+    std::remove(PATH.c_str());
+    return check_result();
+}
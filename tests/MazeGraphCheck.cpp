@@ -0,0 +1,112 @@
+/*****************************************************************************************
+ **                     CHECKS - GRAPHS                                                 **
+ **         The graph holds exactly the passages of the maze, from both of their        **
+ **         rooms, and write() writes the file save() does, for both number sizes.      **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeGraph.h"
+#include "MazeGenerator.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const std::string SAVED   = "MazeGraphCheck.saved.csr";
+    const std::string WRITTEN = "MazeGraphCheck.written.csr";
+
+    std::string file_bytes(const std::string &path){
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // The neighbours of each room, from the walls given by Maze::operator(), in the order of MazeGraph
+    std::vector<std::vector<uint64_t>> maze_neighbours(const Maze &maze){
+        const uint64_t length = maze.LENGTH, plane = length * maze.WIDTH;
+        std::vector<std::vector<uint64_t>> rooms;
+        for (int f = 0; f < maze.HEIGHT; f++){
+            for (int r = 0; r < maze.WIDTH; r++){
+                for (int c = 0; c < maze.LENGTH; c++){
+                    uint64_t node = c + length * r + plane * f;
+                    int walls = maze(r, c, f);
+                    std::vector<uint64_t> next;
+                    if (!(walls & Maze::FLOOR))  next.push_back(node - plane);
+                    if (!(walls & Maze::NORTH))  next.push_back(node - length);
+                    if (!(walls & Maze::WEST))   next.push_back(node - 1);
+                    if (!(walls & Maze::EAST))   next.push_back(node + 1);
+                    if (!(walls & Maze::SOUTH))  next.push_back(node + length);
+                    if (!(walls & Maze::CEIL))   next.push_back(node + plane);
+                    rooms.push_back(next);
+                }
+            }
+        }
+        return rooms;
+    }
+
+    template<class Index>
+    void check_graph(const Maze &maze){
+        const std::vector<std::vector<uint64_t>> expected = maze_neighbours(maze);
+
+        for (unsigned threads : {1u, 3u}){
+            MazeGraph<Index> graph(maze, threads);
+            CHECK(graph.nodes() == expected.size());
+            CHECK(graph.offsets[0] == 0 && graph.offsets.back() == graph.entries());
+
+            bool same = true, symmetric = true;
+            for (std::size_t node = 0; node < graph.nodes() && same; node++){
+                std::vector<uint64_t> next(graph.neighbours.begin() + graph.offsets[node],
+                                           graph.neighbours.begin() + graph.offsets[node + 1]);
+                same &= next == expected[node];
+
+                // Each passage is stored from its other room too
+                for (uint64_t other : next){
+                    auto first = graph.neighbours.begin() + graph.offsets[other];
+                    auto last  = graph.neighbours.begin() + graph.offsets[other + 1];
+                    symmetric &= std::count(first, last, (Index)node) == 1;
+                }
+            }
+            CHECK(same);
+            CHECK(symmetric);
+
+            // The file: the header, then the numbers as in memory
+            graph.save(SAVED);
+            MazeGraph<Index>::write(maze, WRITTEN, threads);
+            const std::string saved = file_bytes(SAVED);
+            CHECK(saved == file_bytes(WRITTEN));
+
+            MazeGraphHeader header;
+            std::memcpy(&header, saved.data(), sizeof(header));
+            CHECK(std::memcmp(header.magic, "MAZECSR", 8) == 0 && header.version == MazeGraphHeader::VERSION);
+            CHECK(header.index_bytes == sizeof(Index) && header.nodes == graph.nodes() && header.entries == graph.entries());
+
+            std::string numbers(reinterpret_cast<const char*>(graph.offsets.data()), graph.offsets.size() * sizeof(Index));
+            numbers.append(reinterpret_cast<const char*>(graph.neighbours.data()), graph.neighbours.size() * sizeof(Index));
+            CHECK(saved.substr(sizeof(header)) == numbers);
+        }
+    }
+}
+
+int main()
+{
+    const int sizes[][3] = {{1, 1, 1}, {1, 1, 6}, {9, 4, 3}, {64, 2, 2}, {65, 3, 4}, {30, 30, 1}};
+
+    for (auto &size : sizes){
+        Maze maze(size[0], size[1], size[2], 0.5, 0.5, 2024);
+        maze.build();
+        check_graph<uint32_t>(maze);
+        check_graph<uint64_t>(maze);
+
+        // Mazes of other shapes: many stairs, or long winding passages
+        maze.build(KruskalGenerator());
+        check_graph<uint32_t>(maze);
+        maze.build(GrowingTreeGenerator(1.0));
+        check_graph<uint64_t>(maze);
+    }
+
+    std::remove(SAVED.c_str());
+    std::remove(WRITTEN.c_str());
+    return check_result();
+}
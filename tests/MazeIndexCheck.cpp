@@ -0,0 +1,78 @@
+/*****************************************************************************************
+ **                     CHECKS - ROUTE INDEX                                            **
+ **         MazeIndex answers as a search does, its file opens for its maze only,      **
+ **         and a regenerated maze needs a new index.                                   **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeIndex.h"
+#include "MazeSolver.h"
+#include "MazeRandom.h"
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+    const std::string PATH = "MazeIndexCheck.index";
+
+    // Are the index's answers those of breadth first search, for count random pairs of rooms?
+    bool answers_as_search(const Maze &maze, const MazeIndex &index, uint64_t seed, int count){
+        MazeSolver solver(maze);
+        MazeRandom random(seed);
+        for (int k = 0; k < count; k++){
+            int r = random(k, 0) % maze.WIDTH,  c = random(k, 1) % maze.LENGTH,  f = random(k, 2) % maze.HEIGHT;
+            int tr = random(k, 3) % maze.WIDTH, tc = random(k, 4) % maze.LENGTH, tf = random(k, 5) % maze.HEIGHT;
+
+            MazeSolver::Path path = solver.bfs(r, c, f, tr, tc, tf);
+            if (index.distance(r, c, f, tr, tc, tf) != path.length || index.path(r, c, f, tr, tc, tf) != path.moves){
+                return false;
+            }
+            if (index.next_step(r, c, f, tr, tc, tf) != (path.moves.empty() ? 0 : path.moves[0])){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool opens(const Maze &maze){
+        try {
+            MazeIndex::open(PATH, maze);
+            return true;
+        } catch (const std::runtime_error &){
+            return false;
+        }
+    }
+}
+
+int main()
+{
+    const int sizes[][3] = {{1, 1, 1}, {20, 15, 3}, {1, 50, 2}, {70, 4, 4}};
+
+    for (auto &size : sizes){
+        Maze maze(size[0], size[1], size[2], 0.5, 0.5, 99);
+        maze.build();
+
+        MazeIndex index(maze);
+        CHECK(answers_as_search(maze, index, 1, 200));
+
+        index.save(PATH);
+        MazeIndex opened = MazeIndex::open(PATH, maze);
+        CHECK(answers_as_search(maze, opened, 2, 200));
+
+        // Another maze of the same size
+        Maze other(size[0], size[1], size[2], 0.5, 0.5, 100);
+        other.build();
+        CHECK(!opens(other) || room_walls(other) == room_walls(maze));
+    }
+
+    // After regenerate the old index no longer opens, and a new one answers for the new walls
+    Maze maze(20, 15, 3, 0.5, 0.5, 7);
+    maze.build();
+    MazeIndex(maze).save(PATH);
+    maze.regenerate(3, 4, 0, 6, 8, 2, 8);
+    CHECK(!opens(maze));
+    CHECK(answers_as_search(maze, MazeIndex(maze), 3, 200));
+
+    std::remove(PATH.c_str());
+    return check_result();
+}
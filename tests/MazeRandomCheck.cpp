@@ -0,0 +1,93 @@
+/*****************************************************************************************
+ **                     CHECKS - RANDOM NUMBERS                                         **
+ **         The bulk draws match the draws of single rooms, with and without AVX2,     **
+ **         and so do the mazes built from them.                                        **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeRandom.h"
+#include "MazeBatch.h"
+
+namespace {
+    // Bulk draws of count rooms from room, as (*this)(room + i, stream) one at a time?
+    bool draws_match(const MazeRandom &random, uint64_t room, uint32_t stream, std::size_t count){
+        std::vector<uint32_t> out(count + 1, 0xdeadbeef);
+        random.draws(room, stream, count, out.data());
+        for (std::size_t i = 0; i < count; i++){
+            if (out[i] != random(room + i, stream)){
+                return false;
+            }
+        }
+        return out[count] == 0xdeadbeef;
+    }
+
+    // Bulk chances, as chance() one at a time, with the rest of the last word cleared and no more words written?
+    bool chances_match(const MazeRandom &random, uint64_t room, uint32_t stream, uint32_t limit, std::size_t count){
+        std::size_t words = (count + 63) / 64;
+        std::vector<uint64_t> bits(words + 1, ~uint64_t(0));
+        random.chances(room, stream, limit, count, bits.data());
+        for (std::size_t i = 0; i < words * 64; i++){
+            bool bit = (bits[i / 64] >> (i % 64)) & 1;
+            if (bit != (i < count && random.chance(room + i, stream, limit))){
+                return false;
+            }
+        }
+        return bits[words] == ~uint64_t(0);
+    }
+
+    // The bulk draws of many rooms, counts, streams and limits, with the current setting
+    bool bulk_draws_match(){
+        MazeRandom random(0x5eed);
+        const uint64_t starts[] = {0, 1, 63, 1000003, ((uint64_t)1 << 32) - 70, ((uint64_t)5 << 32) - 3};
+        const uint32_t limits[] = {0, 1, 0x80000000u, 0xfffffffeu, UINT32_MAX};
+        bool match = true;
+
+        for (uint64_t room : starts){
+            for (std::size_t count = 0; count <= 200; count++){
+                match &= draws_match(random, room, MazeRandom::PICK_DRAW, count);
+                match &= chances_match(random, room, MazeRandom::EAST_DRAW, limits[count % 5], count);
+            }
+            for (std::size_t count : {511, 512, 513, 4097}){
+                match &= draws_match(random, room, MazeRandom::SOUTH_DRAW, count);
+                match &= chances_match(random, room, MazeRandom::SOUTH_DRAW, 0x9999999au, count);
+            }
+        }
+        return match;
+    }
+
+    // The walls of mazes built every way that draws in bulk
+    std::vector<std::vector<uint8_t>> built_mazes(){
+        std::vector<std::vector<uint8_t>> mazes;
+        const int sizes[][3] = {{1, 1, 1}, {63, 4, 3}, {64, 5, 2}, {65, 7, 3}, {200, 9, 2}};
+        for (auto &size : sizes){
+            Maze maze(size[0], size[1], size[2], 0.45, 0.55, 31337);
+            maze.build();
+            mazes.push_back(room_walls(maze));
+            maze.build_parallel(2);
+            mazes.push_back(room_walls(maze));
+
+            MazeBatch batch(size[0], size[1], size[2], 0.45, 0.55);
+            batch.generate(std::vector<uint64_t>{31337, 1}, 1);
+            const uint8_t *bytes = reinterpret_cast<const uint8_t*>(batch.data(1));
+            mazes.push_back(std::vector<uint8_t>(bytes, bytes + batch.maze_words() * sizeof(uint64_t)));
+        }
+        return mazes;
+    }
+}
+
+int main()
+{
+    MazeRandom::use_simd(true);
+    std::cout << "AVX2 " << (MazeRandom::simd() ? "in use" : "not available, checking the portable code only") << "\n";
+    CHECK(bulk_draws_match());
+    std::vector<std::vector<uint8_t>> vector_mazes = built_mazes();
+
+    MazeRandom::use_simd(false);
+    CHECK(!MazeRandom::simd());
+    CHECK(bulk_draws_match());
+    CHECK(built_mazes() == vector_mazes);
+
+    MazeRandom::use_simd(true);
+    return check_result();
+}
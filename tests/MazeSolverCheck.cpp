@@ -0,0 +1,139 @@
+/*****************************************************************************************
+ **                     CHECKS - SOLVER                                                 **
+ **         The three searches find paths of the same, shortest length, whose moves     **
+ **         go through open walls to the goal, in mazes with and without loops.         **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeSolver.h"
+#include "MazeRandom.h"
+#include <memory>
+
+namespace {
+    // Do the moves go through open walls only, from the room to the goal?
+    bool walks_to(const Maze &maze, int row, int col, int floor, int to_row, int to_col, int to_floor,
+                  const std::vector<uint8_t> &moves){
+        for (uint8_t move : moves){
+            if (maze(row, col, floor) & move){
+                return false;
+            }
+            switch (move){
+                case Maze::EAST:  col++;    break;
+                case Maze::WEST:  col--;    break;
+                case Maze::SOUTH: row++;    break;
+                case Maze::NORTH: row--;    break;
+                case Maze::CEIL:  floor++;  break;
+                case Maze::FLOOR: floor--;  break;
+                default:          return false;
+            }
+        }
+        return row == to_row && col == to_col && floor == to_floor;
+    }
+
+    // Searches between count random pairs of rooms: the same lengths, and moves that lead there
+    void check_searches(const Maze &maze, uint64_t seed, int count, bool connected){
+        MazeSolver solver(maze);
+        MazeRandom random(seed);
+        bool agree = true, walks = true, found = true;
+
+        for (int k = 0; k < count; k++){
+            int r = random(k, 0) % maze.WIDTH,  c = random(k, 1) % maze.LENGTH,  f = random(k, 2) % maze.HEIGHT;
+            int tr = random(k, 3) % maze.WIDTH, tc = random(k, 4) % maze.LENGTH, tf = random(k, 5) % maze.HEIGHT;
+
+            MazeSolver::Path paths[3] = {solver.bfs(r, c, f, tr, tc, tf),
+                                         solver.bidirectional(r, c, f, tr, tc, tf),
+                                         solver.astar(r, c, f, tr, tc, tf)};
+            for (auto &path : paths){
+                agree &= path.found == paths[0].found;
+                if (path.found){
+                    agree &= path.length == paths[0].length && path.length == path.moves.size();
+                    walks &= walks_to(maze, r, c, f, tr, tc, tf, path.moves);
+                }
+            }
+            found &= paths[0].found || !connected;
+        }
+        CHECK(agree);
+        CHECK(walks);
+        CHECK(found);
+    }
+
+    // A copy of the maze's walls, to change, and a Maze reading it
+    struct Walls {
+        std::shared_ptr<std::vector<uint64_t>> blocks;
+        Maze maze;
+
+        explicit Walls(const Maze &from)
+            : blocks(std::make_shared<std::vector<uint64_t>>(from.packed().data(), from.packed().data() + from.packed().size())),
+              maze(Maze::view(from.LENGTH, from.WIDTH, from.HEIGHT, 0.5, 0.5, from.SEED, blocks->data(), blocks))
+        {
+        }
+
+        void set(int word, int row, int col, int floor, bool up){
+            std::size_t i = maze.packed().index(row, col, floor);
+            uint64_t bit = uint64_t(1) << (i & 63);
+            uint64_t &block = (*blocks)[(i >> 6) * 3 + word];
+            block = up ? (block | bit) : (block & ~bit);
+        }
+    };
+}
+
+int main()
+{
+    const int sizes[][3] = {{1, 1, 1}, {12, 9, 4}, {1, 60, 1}, {70, 3, 3}};
+
+    for (auto &size : sizes){
+        Maze maze(size[0], size[1], size[2], 0.5, 0.5, 808);
+        maze.build();
+        check_searches(maze, 1, 300, true);
+
+        // The same room: found, without moves
+        MazeSolver solver(maze);
+        int r = size[1] / 2, c = size[0] / 2, f = size[2] / 2;
+        for (auto path : {solver.bfs(r, c, f, r, c, f), solver.bidirectional(r, c, f, r, c, f), solver.astar(r, c, f, r, c, f)}){
+            CHECK(path.found && path.length == 0 && path.moves.empty());
+        }
+
+        // Loops: every fourth inner wall of the maze down, so paths are no longer unique
+        Walls loops(maze);
+        for (int f2 = 0; f2 < size[2]; f2++){
+            for (int r2 = 0; r2 < size[1]; r2++){
+                for (int c2 = 0; c2 < size[0]; c2++){
+                    if ((r2 + 2 * c2 + 3 * f2) % 4 == 0){
+                        if (c2 + 1 < size[0]) loops.set(PackedWalls::EAST_WORD, r2, c2, f2, false);
+                        if (r2 + 1 < size[1]) loops.set(PackedWalls::SOUTH_WORD, r2, c2, f2, false);
+                    }
+                }
+            }
+        }
+        check_searches(loops.maze, 2, 300, true);
+    }
+
+    // Unreachable rooms: a maze with every wall up, and a maze cut in two
+    Maze closed(8, 6, 3, 0.5, 0.5, 1);
+    check_searches(closed, 3, 100, false);
+    MazeSolver closed_solver(closed);
+    CHECK(!closed_solver.bfs(0, 0, 0, 5, 7, 2).found);
+    CHECK(!closed_solver.bidirectional(0, 0, 0, 5, 7, 2).found);
+    CHECK(!closed_solver.astar(0, 0, 0, 5, 7, 2).found);
+    CHECK(closed_solver.components() == 8 * 6 * 3);
+
+    Maze open_maze(8, 6, 1, 0.5, 0.5, 1);
+    open_maze.build();
+    Walls cut(open_maze);
+    for (int row = 0; row < 6; row++){
+        for (int col = 0; col < 8; col++){
+            cut.set(PackedWalls::EAST_WORD, row, col, 0, col == 3 || col == 7);
+            cut.set(PackedWalls::SOUTH_WORD, row, col, 0, row == 5);
+        }
+    }
+    check_searches(cut.maze, 4, 200, false);
+    MazeSolver cut_solver(cut.maze);
+    CHECK(!cut_solver.bfs(0, 0, 0, 5, 7, 0).found);
+    CHECK(!cut_solver.bidirectional(0, 0, 0, 5, 7, 0).found);
+    CHECK(!cut_solver.astar(0, 0, 0, 5, 7, 0).found);
+    CHECK(cut_solver.bfs(0, 0, 0, 5, 3, 0).length == 8);
+    CHECK(cut_solver.components() == 2);
+
+    return check_result();
+}
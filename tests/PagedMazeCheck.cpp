@@ -0,0 +1,83 @@
+/*****************************************************************************************
+ **                     CHECKS - MAZES ON DISK                                          **
+ **         build_to_file writes the file save() writes, byte for byte, PagedMaze      **
+ **         reads the rooms Maze has, and MazePipeline hands over the floors of build().**
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "PagedMaze.h"
+#include "MazePipeline.h"
+#include "MazeAnalysis.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const std::string BUILT = "PagedMazeCheck.built.maze";
+    const std::string SAVED = "PagedMazeCheck.saved.maze";
+
+    std::string file_bytes(const std::string &path){
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
+
+int main()
+{
+    // The last size spans several pages of PagedMaze, so its cache (of one page) has to evict
+    const int sizes[][3] = {{1, 1, 1}, {10, 5, 4}, {64, 2, 3}, {65, 7, 2}, {300, 250, 2}};
+
+    for (auto &size : sizes){
+        const uint64_t seed = 4242 + size[0];
+        Maze maze(size[0], size[1], size[2], 0.45, 0.55, seed);
+        maze.build();
+        maze.save(SAVED);
+
+        uint64_t checksum = Maze::build_to_file(BUILT, size[0], size[1], size[2], 0.45, 0.55, seed);
+        const std::string built = file_bytes(BUILT);
+        CHECK(!built.empty() && built == file_bytes(SAVED));
+
+        Maze opened = Maze::open(BUILT, true);
+        CHECK(MazeAnalysis(opened).perfect());
+
+        PagedMaze paged(BUILT, 1);
+        CHECK(paged.checksum() == checksum);
+        CHECK(paged.verify());
+        CHECK(paged.LENGTH == size[0] && paged.WIDTH == size[1] && paged.HEIGHT == size[2] && paged.SEED == seed);
+
+        // Every room, from several threads at once
+        const std::size_t plane = (std::size_t)size[0] * size[1];
+        const std::vector<uint8_t> walls = room_walls(maze);
+        std::atomic<std::size_t> wrong(0);
+        parallel_for(walls.size(), 4, [&](std::size_t k, unsigned){
+            int floor = (int)(k / plane), row = (int)(k % plane / size[0]), col = (int)(k % size[0]);
+            if (paged(row, col, floor) != walls[k]){
+                wrong++;
+            }
+        });
+        CHECK(wrong == 0);
+        CHECK(paged.cached_pages() <= paged.page_capacity());
+
+        // The floors of the pipeline are the floors of build()
+        MazePipeline pipeline(size[0], size[1], size[2], 0.45, 0.55, seed, 1);
+        MazePipeline::Floor floor;
+        int floors = 0;
+        const PackedWalls &packed = maze.packed();
+        while (pipeline.next(floor)){
+            CHECK(floor.number == floors);
+            CHECK(floor.walls.size() == packed.floor_words());
+            CHECK(std::equal(floor.walls.data(), floor.walls.data() + packed.floor_words(),
+                             packed.data() + packed.floor_words() * floor.number));
+            floors++;
+        }
+        CHECK(floors == size[2]);
+    }
+
+    std::remove(BUILT.c_str());
+    std::remove(SAVED.c_str());
+    return check_result();
+}
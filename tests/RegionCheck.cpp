@@ -0,0 +1,109 @@
+/*****************************************************************************************
+ **                     CHECKS - REGIONS                                                **
+ **         A regenerated box leaves a perfect maze, changes nothing outside the box,   **
+ **         lists exactly the rooms that changed, and is remembered by maze files.      **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "MazeAnalysis.h"
+#include "MazeFile.h"
+#include "PagedMaze.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    const std::string PATH = "RegionCheck.maze";
+
+    // The rooms whose walls differ, in index order (as regenerate lists them)
+    std::vector<std::size_t> differences(const std::vector<uint8_t> &before, const std::vector<uint8_t> &after){
+        std::vector<std::size_t> rooms;
+        for (std::size_t k = 0; k < before.size(); k++){
+            if (before[k] != after[k]){
+                rooms.push_back(k);
+            }
+        }
+        return rooms;
+    }
+}
+
+int main()
+{
+    const int columns = 17, rows = 11, floors = 4;
+
+    // row, col, floor, rows, columns, floors
+    const int boxes[][6] = {{0, 0, 0, 11, 17, 4},   // The whole maze
+                            {3, 5, 1, 1, 1, 1},     // One room
+                            {2, 3, 0, 6, 8, 2},
+                            {0, 9, 2, 11, 8, 2},    // On the edges
+                            {4, 0, 0, 3, 17, 4}};
+
+    for (auto &box : boxes){
+        for (uint64_t seed = 1; seed <= 4; seed++){
+            Maze maze(columns, rows, floors, 0.5, 0.5, 555);
+            maze.build();
+            CHECK(!maze.EDITED);
+            const std::vector<uint8_t> before = room_walls(maze);
+
+            std::vector<Maze::Room> changed = maze.regenerate(box[0], box[1], box[2], box[3], box[4], box[5], seed);
+            const std::vector<uint8_t> after = room_walls(maze);
+            CHECK(MazeAnalysis(maze).perfect());
+            CHECK(maze.EDITED == !changed.empty());
+
+            // Exactly the listed rooms changed, and all of them are in the box
+            std::vector<std::size_t> listed;
+            for (const Maze::Room &room : changed){
+                CHECK(room.row >= box[0] && room.row < box[0] + box[3]);
+                CHECK(room.col >= box[1] && room.col < box[1] + box[4]);
+                CHECK(room.floor >= box[2] && room.floor < box[2] + box[5]);
+                listed.push_back(room.col + (std::size_t)columns * room.row + (std::size_t)columns * rows * room.floor);
+            }
+            CHECK(listed == differences(before, after));
+
+            // The same seed on the same maze carves the same box
+            Maze again(columns, rows, floors, 0.5, 0.5, 555);
+            again.build();
+            again.regenerate(box[0], box[1], box[2], box[3], box[4], box[5], seed);
+            CHECK(room_walls(again) == after);
+        }
+    }
+
+    // Files remember the edit, and building again forgets it
+    Maze maze(columns, rows, floors, 0.5, 0.5, 555);
+    maze.build();
+    maze.save(PATH);
+    CHECK(!Maze::open(PATH).EDITED);
+    CHECK(!PagedMaze(PATH).EDITED);
+
+    CHECK(!maze.regenerate(2, 3, 0, 6, 8, 2, 1).empty());
+    maze.save(PATH);
+    Maze opened = Maze::open(PATH, true);
+    CHECK(opened.EDITED);
+    CHECK(PagedMaze(PATH).EDITED);
+    CHECK(room_walls(opened) == room_walls(maze));
+
+    opened.build();
+    CHECK(!opened.EDITED);
+    maze.build_parallel(2);
+    CHECK(!maze.EDITED);
+
+    // Flags from a later version are refused
+    {
+        std::fstream file(PATH, std::ios::binary | std::ios::in | std::ios::out);
+        MazeFileHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        header.flags |= 2;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    bool refused = false;
+    try {
+        Maze::open(PATH);
+    } catch (const std::runtime_error &){
+        refused = true;
+    }
+    CHECK(refused);
+
+    std::remove(PATH.c_str());
+    return check_result();
+}
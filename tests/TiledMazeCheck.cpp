@@ -0,0 +1,52 @@
+/*****************************************************************************************
+ **                     CHECKS - TILED MAZE                                             **
+ **         Neighbouring tiles agree, whole tiles form a perfect maze,                  **
+ **         and the cache stays in its budget without changing the maze.                **
+ **                                                                                     **
+ *****************************************************************************************/
+
+#include "MazeChecks.h"
+#include "TiledMaze.h"
+
+int main()
+{
+    const int TILE_COLUMNS = 7, TILE_ROWS = 5, TILE_FLOORS = 3;
+
+    for (uint64_t seed : {1ull, 42ull, 977ull}){
+        TiledMaze world(TILE_COLUMNS, TILE_ROWS, TILE_FLOORS, 0.5, 0.5, seed);
+
+        // Whole tiles from the first one: every tile links WEST, NORTH or down, so they form a perfect maze
+        const int columns = 4 * TILE_COLUMNS, rows = 3 * TILE_ROWS, floors = 3 * TILE_FLOORS;
+        std::vector<uint8_t> walls;
+        world.region(0, 0, 0, rows, columns, floors, walls);
+        CHECK(perfect_box(walls, columns, rows, floors));
+
+        // Both sides of every wall agree, across tile borders too
+        std::vector<uint8_t> box;
+        const int64_t row = 1000003, col = 2000, floor = 77;
+        world.region(row, col, floor, 12, 16, 8, box);
+        bool agree = true;
+        for (int f = 0; f < 8; f++){
+            for (int r = 0; r < 12; r++){
+                for (int c = 0; c < 16; c++){
+                    uint8_t here = box[c + 16 * r + 16 * 12 * f];
+                    if (c + 1 < 16)  agree &= !(here & Maze::EAST)  == !(box[c + 1 + 16 * r + 16 * 12 * f] & Maze::WEST);
+                    if (r + 1 < 12)  agree &= !(here & Maze::SOUTH) == !(box[c + 16 * (r + 1) + 16 * 12 * f] & Maze::NORTH);
+                    if (f + 1 < 8)   agree &= !(here & Maze::CEIL)  == !(box[c + 16 * r + 16 * 12 * (f + 1)] & Maze::FLOOR);
+                    agree &= here == world(row + r, col + c, floor + f);
+                }
+            }
+        }
+        CHECK(agree);
+
+        // A cache of one tile evicts all the time, but gives the same maze
+        TiledMaze small(TILE_COLUMNS, TILE_ROWS, TILE_FLOORS, 0.5, 0.5, seed, 1);
+        std::vector<uint8_t> again;
+        small.region(row, col, floor, 12, 16, 8, again);
+        CHECK(again == box);
+        CHECK(small.cached_tiles() <= small.tile_capacity());
+        CHECK(world.cached_tiles() <= world.tile_capacity());
+    }
+
+    return check_result();
+}